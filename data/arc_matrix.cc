@@ -0,0 +1,70 @@
+#include "data/arc_matrix.h"
+#include <cassert>
+
+void ArcMatrix::Build(const FlatTable<int> &distance,
+                      const FlatTable<int> &time) {
+    assert(distance.rows() == distance.cols());
+    assert(time.rows() == distance.rows() && time.cols() == distance.cols());
+    n = distance.rows();
+    symmetric = true;
+    narrow = true;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            int d = distance(i, j), t = time(i, j);
+            if (d < -1 || d > 0xfffe || t < -1 || t > 0xfffe)
+                narrow = false;
+            if (j < i && (d != distance(j, i) || t != time(j, i)))
+                symmetric = false;
+        }
+    }
+    size_t num_cells = symmetric ? static_cast<size_t>(n) * (n + 1) / 2
+                                 : static_cast<size_t>(n) * n;
+    cells16 = FlatTable<uint16_t>();
+    cells32 = FlatTable<int32_t>();
+    if (narrow)
+        cells16.Assign(1, 2 * num_cells, 0);
+    else
+        cells32.Assign(1, 2 * num_cells, 0);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < (symmetric ? i + 1 : n); ++j) {
+            size_t k = 2 * Cell(i, j);
+            if (narrow) {
+                cells16.at(0, k) = distance(i, j) + 1;
+                cells16.at(0, k + 1) = time(i, j) + 1;
+            } else {
+                cells32.at(0, k) = distance(i, j);
+                cells32.at(0, k + 1) = time(i, j);
+            }
+        }
+    }
+}
+
+void ArcMatrix::Save(BinaryWriter &w) const {
+    w.Pod(static_cast<int32_t>(n));
+    w.Pod(static_cast<uint8_t>(symmetric));
+    w.Pod(static_cast<uint8_t>(narrow));
+    if (narrow)
+        w.Table(cells16);
+    else
+        w.Table(cells32);
+}
+
+void ArcMatrix::Load(BinaryReader &r) {
+    n = r.Pod<int32_t>();
+    symmetric = r.Pod<uint8_t>();
+    narrow = r.Pod<uint8_t>();
+    size_t num_cells = symmetric ? static_cast<size_t>(n) * (n + 1) / 2
+                                 : static_cast<size_t>(n) * n;
+    cells16 = FlatTable<uint16_t>();
+    cells32 = FlatTable<int32_t>();
+    size_t got;
+    if (narrow) {
+        r.Table(cells16);
+        got = cells16.size();
+    } else {
+        r.Table(cells32);
+        got = cells32.size();
+    }
+    if (n < 0 || got != 2 * num_cells)
+        r.Fail("arc matrix size does not match its shape");
+}
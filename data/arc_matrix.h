@@ -0,0 +1,70 @@
+#ifndef _ARC_MATRIX_H_
+#define _ARC_MATRIX_H_
+#include <cstddef>
+#include <cassert>
+#include <stdint.h>
+#include "data/flat_table.h"
+#include "data/binary_io.h"
+
+// Distance and travel time of every client pair, packed at load time:
+// the pair of an arc is stored next to each other, in 16-bit cells when
+// every value fits (-1, a missing edge, included), and only the lower
+// triangle is kept when the instance is symmetric.
+class ArcMatrix {
+ public:
+    struct Arc {
+        int distance;
+        int time;
+    };
+    ArcMatrix(): n(0), symmetric(false), narrow(false) { }
+    // full n x n matrices, -1 for a missing edge
+    void Build(const FlatTable<int> &distance, const FlatTable<int> &time);
+    void Save(BinaryWriter&) const;
+    void Load(BinaryReader&);   // views the reader's memory
+    Arc arc(int from, int to) const {
+        size_t k = 2 * Cell(from, to);
+        Arc a;
+        if (narrow) {
+            a.distance = static_cast<int>(cells16.data()[k]) - 1;
+            a.time = static_cast<int>(cells16.data()[k + 1]) - 1;
+        } else {
+            a.distance = cells32.data()[k];
+            a.time = cells32.data()[k + 1];
+        }
+        return a;
+    }
+    int distance(int from, int to) const {
+        size_t k = 2 * Cell(from, to);
+        return narrow ? static_cast<int>(cells16.data()[k]) - 1
+                      : cells32.data()[k];
+    }
+    int time(int from, int to) const {
+        size_t k = 2 * Cell(from, to) + 1;
+        return narrow ? static_cast<int>(cells16.data()[k]) - 1
+                      : cells32.data()[k];
+    }
+    int size() const { return n; }
+    bool IsSymmetric() const { return symmetric; }
+    size_t bytes() const {
+        return cells16.size() * sizeof(uint16_t) +
+               cells32.size() * sizeof(int32_t);
+    }
+ private:
+    size_t Cell(int from, int to) const {
+        assert(from >= 0 && from < n && to >= 0 && to < n);
+        if (!symmetric)
+            return static_cast<size_t>(from) * n + to;
+        if (from < to) {
+            int t = from;
+            from = to;
+            to = t;
+        }
+        return static_cast<size_t>(from) * (from + 1) / 2 + to;
+    }
+    int n;
+    bool symmetric;
+    bool narrow;
+    FlatTable<uint16_t> cells16;  // value + 1
+    FlatTable<int32_t> cells32;
+};
+#endif
@@ -1,71 +1,121 @@
-#include <iostream>
-#include <sstream>
 #include <string>
 #include <vector>
 #include <cmath>
+#include <cctype>
 #include "data/billing.h"
 
-const int kBufSize = 200;
-
-void LoadKmBilling::ReadInputData(std::istream &is, int num_region) {
-    char buffer[kBufSize];
+void LoadKmBilling::ReadInputData(TextScanner &sc, int num_region) {
     double n;
 
-    is  >> n;
+    n = sc.Decimal("km rate");
     // changed from unsigned to int
     km_rate = static_cast<int>(ceil(n*1000));
 
-    is >> n;
+    n = sc.Decimal("full load percentage");
     full_load_value = static_cast<int>(n*100);
 
-    is.getline(buffer, kBufSize);
+    sc.SkipLine();
 
     load_cost.resize(num_region);
 
     for (unsigned i = 0; i < load_cost.size(); ++i) {
-      is  >> n;
+      n = sc.Decimal("load cost");
       load_cost[i] = static_cast<int>(ceil(n*1000));
   }
 
-  is.getline(buffer, kBufSize);
+  sc.SkipLine();
 }
 
-void VarLoadBilling::ReadInputData(std::istream &is, int num_region) {
-    char buffer[kBufSize];
+// The load costs come as one group of num_range numbers per region,
+// each group closed by ';'. Numbers past num_range in a group are
+// ignored.
+void VarLoadBilling::ReadInputData(TextScanner &sc, int num_region) {
     double n;
 
-    is >> num_range;
+    num_range = sc.Int("number of load bands");
+    if (num_range < 2)
+        sc.Fail("bt3 needs at least two load bands");
     levels.resize(num_range-1);
     for (unsigned i = 0; i < levels.size(); ++i) {
-        is >> levels[i];  // in kg
+        levels[i] = sc.Int("load band");  // in kg
     }
-    is.getline(buffer, kBufSize);
+    sc.SkipLine();
 
     load_cost.resize(num_region);
 
     for (int i = 0; i < num_region; ++i) {
         load_cost[i].resize(num_range);
-        is.getline(buffer, kBufSize, ';');
-        std::string s(buffer);
-        std::istringstream istr(s);
+        const char *b, *e;
+        sc.Until(';', &b, &e);
         for (int j = 0; j < num_range; ++j) {
-            istr >> n;
+            while (b < e && isspace(static_cast<unsigned char>(*b))) ++b;
+            const char *stop;
+            n = ParseDecimal(b, e, &stop);
+            if (stop == b)
+                sc.Fail("bt3 load costs: too few numbers for a region");
+            b = stop;
             load_cost[i][j] = static_cast<int>(ceil(n*1000));
         }
     }
-    is.getline(buffer, kBufSize);
+    sc.SkipLine();
 }
 
-void LoadBilling::ReadInputData(std::istream &is, int num_region) {
-    char buffer[kBufSize];
+void LoadBilling::ReadInputData(TextScanner &sc, int num_region) {
     double n;
 
     load_cost.resize(num_region);
 
     for (unsigned i = 0; i < load_cost.size(); ++i) {
-      is  >> n;
+      n = sc.Decimal("load cost");
       load_cost[i] = static_cast<int>(ceil(n*1000));
     }
 
-    is.getline(buffer, kBufSize);
+    sc.SkipLine();
+}
+
+void KmBilling::Save(BinaryWriter &w) const {
+    w.Pod(km_rate);
+}
+
+void KmBilling::Load(BinaryReader &r) {
+    km_rate = r.Pod<int>();
+}
+
+void LoadKmBilling::Save(BinaryWriter &w) const {
+    w.Pod(km_rate);
+    w.Pod(full_load_value);
+    w.Array(load_cost);
+}
+
+void LoadKmBilling::Load(BinaryReader &r) {
+    km_rate = r.Pod<int>();
+    full_load_value = r.Pod<int>();
+    r.Array(load_cost);
+}
+
+void VarLoadBilling::Save(BinaryWriter &w) const {
+    w.Pod(num_range);
+    w.Array(levels);
+    w.Pod(static_cast<uint32_t>(load_cost.size()));
+    for (unsigned i = 0; i < load_cost.size(); ++i)
+        w.Array(load_cost[i]);
+}
+
+void VarLoadBilling::Load(BinaryReader &r) {
+    num_range = r.Pod<int>();
+    r.Array(levels);
+    load_cost.resize(r.Pod<uint32_t>());
+    for (unsigned i = 0; i < load_cost.size(); ++i) {
+        r.Array(load_cost[i]);
+        if (static_cast<int>(load_cost[i].size()) != num_range)
+            r.Fail("bt3 load costs do not match the load bands");
+    }
+}
+
+void LoadBilling::Save(BinaryWriter &w) const {
+    w.Array(load_cost);
+}
+
+void LoadBilling::Load(BinaryReader &r) {
+    r.Array(load_cost);
 }
@@ -5,12 +5,15 @@
 #include <vector>
 #include <cassert>
 #include "helpers/billing_cost_component.h"
+#include "data/text_scanner.h"
+#include "data/binary_io.h"
 
 // class BillingCostComponent;
 
 class Billing {
  public:
-    Billing(std::string i, std::string t):
+    // t is the number of the cost function (bt1 ... bt5)
+    Billing(int i, int t):
         id(i), type(t) { }
     virtual ~Billing() { /*delete cost_component;*/ }
     void SetCostComponent(BillingCostComponent* cc) {
@@ -20,21 +23,26 @@ class Billing {
         return (*cost_component);
     }
     // size_t CostComponents() const { return cost_component.size(); }
-    std::string get_id() const { return id; }
-    std::string get_type() const { return type; }
+    int get_id() const { return id; }
+    int get_type() const { return type; }
+    // compiled instances
+    virtual void Save(BinaryWriter&) const { }
+    virtual void Load(BinaryReader&) { }
 
  protected:
-    std::string id, type;
+    int id, type;
     BillingCostComponent *cost_component;
 };
 
 // KM BILLING (cost function 1)
 class KmBilling: public Billing {
  public:
-    KmBilling(std::string i, std::string t, unsigned rate):
+    KmBilling(int i, int t, unsigned rate):
         Billing(i, t), km_rate(rate) { }
     ~KmBilling() { }
     int get_km_rate() const { return km_rate; }
+    void Save(BinaryWriter&) const;
+    void Load(BinaryReader&);
  private:
     int km_rate;
 };
@@ -42,7 +50,7 @@ class KmBilling: public Billing {
 // LOAD KM BILLING (cost function 2)
 class LoadKmBilling: public Billing {
  public:
-    LoadKmBilling(std::string i, std::string t):
+    LoadKmBilling(int i, int t):
         Billing(i, t) { }
     ~LoadKmBilling() { }
     int get_km_rate() const { return km_rate; }
@@ -51,7 +59,9 @@ class LoadKmBilling: public Billing {
         assert(r_index < load_cost.size());
         return load_cost[r_index];
     }
-    void ReadInputData(std::istream&, int);
+    void ReadInputData(TextScanner&, int);
+    void Save(BinaryWriter&) const;
+    void Load(BinaryReader&);
  private:
     int km_rate;
     int full_load_value;
@@ -61,7 +71,7 @@ class LoadKmBilling: public Billing {
 // VAR LOAD BILLING (cost function 3)
 class VarLoadBilling: public Billing {
  public:
-    VarLoadBilling(std::string i, std::string t):
+    VarLoadBilling(int i, int t):
         Billing(i, t) { }
     ~VarLoadBilling() { }
     int get_num_range() const { return num_range; }
@@ -70,7 +80,9 @@ class VarLoadBilling: public Billing {
         return load_cost[r_index][range];
     }
     int get_level(unsigned i) const { return levels[i]; }
-    void ReadInputData(std::istream&, int);
+    void ReadInputData(TextScanner&, int);
+    void Save(BinaryWriter&) const;
+    void Load(BinaryReader&);
  private:
     int num_range;
     std::vector<std::vector<int> > load_cost;
@@ -80,10 +92,12 @@ class VarLoadBilling: public Billing {
 // LOAD BILLING (cost funtion 4)
 class LoadBilling: public Billing {
  public:
-    LoadBilling(std::string i, std::string t):
+    LoadBilling(int i, int t):
         Billing(i, t) { }
     ~LoadBilling() { }
-    void ReadInputData(std::istream&, int);
+    void ReadInputData(TextScanner&, int);
+    void Save(BinaryWriter&) const;
+    void Load(BinaryReader&);
     int get_load_cost(unsigned r_index) const {
         assert(r_index < load_cost.size());
         return load_cost[r_index];
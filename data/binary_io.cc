@@ -0,0 +1,37 @@
+#include "data/binary_io.h"
+#include <string>
+#include <vector>
+#include <sstream>
+#include <stdexcept>
+
+void BinaryWriter::Align() {
+    static const char zeros[8] = { 0 };
+    if (pos % 8)
+        Raw(zeros, 8 - pos % 8);
+}
+
+size_t BinaryReader::Size(size_t sz) {
+    uint64_t n = Pod<uint64_t>();
+    Align();
+    if (n > static_cast<uint64_t>(end - cur) / sz)
+        Fail("truncated array");
+    return n;
+}
+
+void BinaryReader::Tag(const char *t) {
+    const char *p = Take(4);
+    if (memcmp(p, t, 4))
+        Fail(std::string("expected section ") + std::string(t, 4));
+}
+
+void BinaryReader::Align() {
+    size_t off = cur - begin;
+    if (off % 8)
+        Take(8 - off % 8);
+}
+
+void BinaryReader::Fail(const std::string &msg) const {
+    std::ostringstream os;
+    os << source << ": offset " << (cur - begin) << ": " << msg;
+    throw std::runtime_error(os.str());
+}
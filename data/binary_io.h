@@ -0,0 +1,107 @@
+#ifndef _BINARY_IO_H_
+#define _BINARY_IO_H_
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <stdint.h>
+#include "data/flat_table.h"
+
+// Raw native-endian records for compiled instances. Arrays start on
+// 8-byte boundaries (relative to the start of the file) so that a
+// mapped file can be read in place: tables are not copied out, they
+// view the mapping, which must outlive them.
+class BinaryWriter {
+ public:
+    explicit BinaryWriter(std::ostream &o): os(o), pos(0) { }
+    template <class T> void Pod(const T &v) { Raw(&v, sizeof(T)); }
+    template <class T> void Array(const std::vector<T> &v) {
+        Pod(static_cast<uint64_t>(v.size()));
+        Align();
+        if (v.size())
+            Raw(&v[0], v.size() * sizeof(T));
+    }
+    template <class T> void Table(const FlatTable<T> &t) {
+        Pod(static_cast<int32_t>(t.rows()));
+        Pod(static_cast<int32_t>(t.cols()));
+        Pod(static_cast<uint64_t>(t.size()));
+        Align();
+        if (t.size())
+            Raw(t.data(), t.size() * sizeof(T));
+    }
+    void Bits(const BitTable &t) {
+        Pod(static_cast<int32_t>(t.bits()));
+        Table(t.words());
+    }
+    void String(const std::string &s) {
+        Pod(static_cast<uint32_t>(s.size()));
+        Raw(s.data(), s.size());
+    }
+    void Tag(const char *t) { Raw(t, 4); }
+    void Align();
+    void Raw(const void *p, size_t n) {
+        os.write(static_cast<const char*>(p), n);
+        pos += n;
+    }
+    size_t offset() const { return pos; }
+ private:
+    std::ostream &os;
+    size_t pos;
+};
+
+class BinaryReader {
+ public:
+    BinaryReader(const char *b, const char *e, const std::string &src):
+        begin(b), cur(b), end(e), source(src) { }
+    template <class T> T Pod() {
+        T v;
+        memcpy(&v, Take(sizeof(T)), sizeof(T));
+        return v;
+    }
+    template <class T> void Array(std::vector<T> &v) {
+        size_t n = Size(sizeof(T));
+        const T *p = static_cast<const T*>(View(n * sizeof(T)));
+        v.assign(p, p + n);
+    }
+    template <class T> void Table(FlatTable<T> &t) {
+        int32_t rows = Pod<int32_t>();
+        int32_t cols = Pod<int32_t>();
+        size_t n = Size(sizeof(T));
+        if (rows < 0 || cols < 0 || n != static_cast<size_t>(rows) * cols)
+            Fail("table size does not match its shape");
+        t.View(static_cast<const T*>(View(n * sizeof(T))), rows, cols);
+    }
+    void Bits(BitTable &t) {
+        int32_t bits = Pod<int32_t>();
+        FlatTable<uint64_t> words;
+        Table(words);
+        if (bits < 0 || words.cols() != BitTable::WordsFor(bits))
+            Fail("bit table size does not match its shape");
+        t.View(words.data(), words.rows(), bits);
+    }
+    // Count of an array of elements of size sz, leaving the reader on
+    // the (aligned) first element.
+    size_t Size(size_t sz);
+    const void* View(size_t bytes) { return Take(bytes); }
+    std::string String() {
+        uint32_t n = Pod<uint32_t>();
+        const char *p = Take(n);
+        return std::string(p, n);
+    }
+    void Tag(const char *t);
+    void Align();
+    void Fail(const std::string &msg) const;
+    size_t offset() const { return cur - begin; }
+ private:
+    const char* Take(size_t n) {
+        if (static_cast<size_t>(end - cur) < n)
+            Fail("truncated file");
+        const char *p = cur;
+        cur += n;
+        return p;
+    }
+    const char *begin, *cur, *end;
+    std::string source;
+};
+
+#endif
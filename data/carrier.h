@@ -8,12 +8,12 @@
 class Carrier {
     // friend std::istream& operator>>(std::istream&, const Carrier&);
  public:
-    Carrier(std::string cid, std::string bid):
+    Carrier(int cid, int bid):
         id(cid), id_billing(bid) { }
-    std::string get_id() const { return id; }
-    std::string get_billing() const { return id_billing; }
+    int get_id() const { return id; }
+    int get_billing() const { return id_billing; }
  private:
-    std::string id, id_billing;
+    int id, id_billing;
     // std::vector<bool> incompat_regions;
 };
 #endif
@@ -0,0 +1,98 @@
+#ifndef _FLAT_TABLE_H_
+#define _FLAT_TABLE_H_
+#include <vector>
+#include <cstddef>
+#include <cassert>
+#include <stdint.h>
+
+// Row-major rows x cols table in one block. It either owns its elements
+// or views memory owned by someone else, e.g. a mapped compiled instance
+// shared by several processes; a viewed table is read-only.
+template <class T>
+class FlatTable {
+ public:
+    FlatTable(): data_(NULL), rows_(0), cols_(0) { }
+    FlatTable(const FlatTable &t) { *this = t; }
+    FlatTable& operator=(const FlatTable &t) {
+        own_ = t.own_;
+        data_ = t.IsView() ? t.data_ : own_.data();
+        rows_ = t.rows_;
+        cols_ = t.cols_;
+        return *this;
+    }
+    void Assign(int rows, int cols, const T &v) {
+        own_.assign(static_cast<size_t>(rows) * cols, v);
+        data_ = own_.data();
+        rows_ = rows;
+        cols_ = cols;
+    }
+    void View(const T *p, int rows, int cols) {
+        own_.clear();
+        data_ = p;
+        rows_ = rows;
+        cols_ = cols;
+    }
+    bool IsView() const { return data_ && own_.empty(); }
+    const T& operator()(int r, int c) const {
+        assert(r >= 0 && r < rows_ && c >= 0 && c < cols_);
+        return data_[static_cast<size_t>(r) * cols_ + c];
+    }
+    T& at(int r, int c) {
+        assert(!IsView() && r >= 0 && r < rows_ && c >= 0 && c < cols_);
+        return own_[static_cast<size_t>(r) * cols_ + c];
+    }
+    const T* row(int r) const { return data_ + static_cast<size_t>(r) * cols_; }
+    const T* data() const { return data_; }
+    size_t size() const { return static_cast<size_t>(rows_) * cols_; }
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+ private:
+    std::vector<T> own_;
+    const T *data_;
+    int rows_;
+    int cols_;
+};
+
+// Index of the lowest set bit of a non-zero word; clear it with
+// w &= w - 1 to walk all of them.
+inline int LowestBit(uint64_t w) { return __builtin_ctzll(w); }
+
+// rows x bits bit matrix, one run of 64-bit words per row.
+class BitTable {
+ public:
+    BitTable(): bits_(0) { }
+    static int WordsFor(int bits) { return (bits + 63) / 64; }
+    void Assign(int rows, int bits, bool v) {
+        bits_ = bits;
+        words_.Assign(rows, WordsFor(bits), v ? ~uint64_t(0) : 0);
+        if (v && bits % 64)  // keep the padding bits clear
+            for (int r = 0; r < rows; ++r)
+                words_.at(r, WordsFor(bits) - 1) =
+                    (uint64_t(1) << (bits % 64)) - 1;
+    }
+    void View(const uint64_t *p, int rows, int bits) {
+        bits_ = bits;
+        words_.View(p, rows, WordsFor(bits));
+    }
+    bool Test(int r, int b) const {
+        assert(b >= 0 && b < bits_);
+        return (words_(r, b / 64) >> (b % 64)) & 1;
+    }
+    void Set(int r, int b, bool v) {
+        assert(b >= 0 && b < bits_);
+        uint64_t mask = uint64_t(1) << (b % 64);
+        if (v)
+            words_.at(r, b / 64) |= mask;
+        else
+            words_.at(r, b / 64) &= ~mask;
+    }
+    const uint64_t* row(int r) const { return words_.row(r); }
+    uint64_t* mutable_row(int r) { return &words_.at(r, 0); }
+    const FlatTable<uint64_t>& words() const { return words_; }
+    int rows() const { return words_.rows(); }
+    int bits() const { return bits_; }
+ private:
+    FlatTable<uint64_t> words_;
+    int bits_;
+};
+#endif
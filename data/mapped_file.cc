@@ -0,0 +1,133 @@
+#include "data/mapped_file.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include <stdint.h>
+
+namespace {
+
+// A shared segment starts with this header; the image follows it on an
+// 8-byte boundary. ready is set once the image is complete.
+struct SegmentHeader {
+    uint64_t ready;
+    uint64_t size;
+};
+
+const int kOpenRetries = 1000;   // 10ms apart
+
+std::runtime_error Error(const std::string &path, int err) {
+    return std::runtime_error(path + ": " + strerror(err));
+}
+
+}  // namespace
+
+MappedFile::MappedFile(const std::string &path):
+    path_(path), base_(NULL), length_(0), data_(NULL), size_(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw Error(path, errno);
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        int err = errno;
+        close(fd);
+        throw Error(path, err);
+    }
+    size_ = length_ = st.st_size;
+    if (size_) {
+        base_ = mmap(NULL, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base_ == MAP_FAILED) {
+            int err = errno;
+            close(fd);
+            throw Error(path, err);
+        }
+        madvise(base_, length_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(base_);
+    }
+    close(fd);  // the mapping keeps the file alive
+}
+
+MappedFile::MappedFile(const std::string &path, void *base, size_t length,
+                       size_t offset):
+    path_(path), base_(base), length_(length),
+    data_(static_cast<const char*>(base) + offset),
+    size_(length - offset) {
+}
+
+MappedFile::~MappedFile() {
+    if (base_)
+        munmap(base_, length_);
+}
+
+MappedFile* MappedFile::OpenShared(const std::string &name) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        if (errno == ENOENT)
+            return NULL;
+        throw Error(name, errno);
+    }
+    // the creator sizes the segment right after creating it
+    struct stat st;
+    int retries = 0;
+    while (fstat(fd, &st) == 0 &&
+           static_cast<size_t>(st.st_size) < sizeof(SegmentHeader) &&
+           ++retries < kOpenRetries)
+        usleep(10000);
+    if (static_cast<size_t>(st.st_size) < sizeof(SegmentHeader)) {
+        close(fd);
+        throw std::runtime_error(name + ": shared segment never sized");
+    }
+    size_t length = st.st_size;
+    void *p = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    int err = errno;
+    close(fd);
+    if (p == MAP_FAILED)
+        throw Error(name, err);
+    const SegmentHeader *h = static_cast<const SegmentHeader*>(p);
+    while (!__atomic_load_n(&h->ready, __ATOMIC_ACQUIRE) &&
+           ++retries < kOpenRetries)
+        usleep(10000);
+    if (!__atomic_load_n(&h->ready, __ATOMIC_ACQUIRE) ||
+        h->size > length - sizeof(SegmentHeader)) {
+        munmap(p, length);
+        throw std::runtime_error(name + ": shared segment is incomplete");
+    }
+    MappedFile *mf = new MappedFile(name, p, length, sizeof(SegmentHeader));
+    mf->size_ = h->size;
+    return mf;
+}
+
+MappedFile* MappedFile::CreateShared(const std::string &name,
+                                     const std::string &image) {
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        if (errno == EEXIST)
+            return NULL;
+        throw Error(name, errno);
+    }
+    size_t length = sizeof(SegmentHeader) + image.size();
+    void *p = MAP_FAILED;
+    if (ftruncate(fd, length) == 0)
+        p = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int err = errno;
+    close(fd);
+    if (p == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        throw Error(name, err);
+    }
+    SegmentHeader *h = static_cast<SegmentHeader*>(p);
+    h->size = image.size();
+    memcpy(h + 1, image.data(), image.size());
+    __atomic_store_n(&h->ready, 1, __ATOMIC_RELEASE);
+    mprotect(p, length, PROT_READ);
+    return new MappedFile(name, p, length, sizeof(SegmentHeader));
+}
+
+void MappedFile::RemoveShared(const std::string &name) {
+    if (shm_unlink(name.c_str()) < 0 && errno != ENOENT)
+        throw Error(name, errno);
+}
@@ -0,0 +1,34 @@
+#ifndef _MAPPED_FILE_H_
+#define _MAPPED_FILE_H_
+#include <string>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file. The mapping is released
+// when the object goes out of scope.
+class MappedFile {
+ public:
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+    // Named POSIX shared-memory segments holding an immutable image.
+    // OpenShared returns NULL if the segment does not exist and waits
+    // for a segment still being filled by CreateShared; CreateShared
+    // returns NULL if another process created the segment first.
+    static MappedFile* OpenShared(const std::string &name);
+    static MappedFile* CreateShared(const std::string &name,
+                                    const std::string &image);
+    static void RemoveShared(const std::string &name);
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    const std::string& path() const { return path_; }
+ private:
+    MappedFile(const std::string &path, void *base, size_t length,
+               size_t offset);
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+    std::string path_;
+    void *base_;
+    size_t length_;
+    const char *data_;
+    size_t size_;
+};
+#endif
@@ -49,3 +49,124 @@ bool IntraSwap::operator==(const IntraSwap &m) const {
 bool IntraSwap::operator!=(const IntraSwap &m) const {
     return !(operator==(m));
 }
+
+std::ostream& operator<<(std::ostream &os, const TwoOptMove &mv) {
+    os << "(" << mv.ord1 << ", " << mv.ord2 << ", "
+       << mv.route << ", " << mv.pos1 << ", " << mv.pos2
+       << ")";
+    return os;
+}
+
+bool TwoOptMove::operator==(const TwoOptMove &m) const {
+    return (ord1 == m.ord1) && (ord2 == m.ord2) && (route == m.route)
+           && (pos1 == m.pos1) && (pos2 == m.pos2);
+}
+
+bool TwoOptMove::operator!=(const TwoOptMove &m) const {
+    return !(operator==(m));
+}
+
+const unsigned OrOptMove::kMaxLen;
+
+std::ostream& operator<<(std::ostream &os, const OrOptMove &mv) {
+    os << "orders: [";
+    for (unsigned k = 0; k < mv.len; ++k)
+        os << (k ? ", " : "") << mv.orders[k];
+    os << "], old: (" << mv.old_route << ", " << mv.old_pos << "), "
+       << "new: (" << mv.new_route << ", " << mv.new_pos << ")";
+    return os;
+}
+
+bool OrOptMove::operator==(const OrOptMove &m) const {
+    if (len != m.len || old_route != m.old_route || old_pos != m.old_pos
+        || new_route != m.new_route || new_pos != m.new_pos)
+        return false;
+    for (unsigned k = 0; k < len; ++k)
+        if (orders[k] != m.orders[k])
+            return false;
+    return true;
+}
+
+bool OrOptMove::operator!=(const OrOptMove &m) const {
+    return !(operator==(m));
+}
+
+const unsigned CrossExchange::kMaxLen;
+
+std::ostream& operator<<(std::ostream &os, const CrossExchange &mv) {
+    os << "(" << mv.ord1 << ", " << mv.ord2 << ", "
+       << mv.route1 << ", " << mv.pos1 << "+" << mv.len1 << ", "
+       << mv.route2 << ", " << mv.pos2 << "+" << mv.len2 << ")";
+    return os;
+}
+
+bool CrossExchange::operator==(const CrossExchange &m) const {
+    return (route1 == m.route1) && (pos1 == m.pos1) && (len1 == m.len1)
+           && (route2 == m.route2) && (pos2 == m.pos2) && (len2 == m.len2);
+}
+
+bool CrossExchange::operator!=(const CrossExchange &m) const {
+    return !(operator==(m));
+}
+
+std::ostream& operator<<(std::ostream &os, const RouteSwap &mv) {
+    os << "(" << mv.route1 << ", " << mv.route2 << ")";
+    return os;
+}
+
+bool RouteSwap::operator==(const RouteSwap &m) const {
+    return (route1 == m.route1) && (route2 == m.route2);
+}
+
+bool RouteSwap::operator!=(const RouteSwap &m) const {
+    return !(operator==(m));
+}
+
+const unsigned EjectionChain::kMaxDepth;
+
+std::ostream& operator<<(std::ostream &os, const EjectionChain &mv) {
+    os << "(" << mv.routes[0];
+    for (unsigned k = 0; k < mv.depth; ++k)
+        os << ", " << mv.orders[k] << "@" << mv.old_pos[k] << " -> "
+           << mv.routes[k + 1] << "@" << mv.new_pos[k];
+    os << ")";
+    return os;
+}
+
+bool EjectionChain::operator==(const EjectionChain &m) const {
+    if (depth != m.depth || routes[0] != m.routes[0])
+        return false;
+    for (unsigned k = 0; k < depth; ++k)
+        if (routes[k + 1] != m.routes[k + 1] || old_pos[k] != m.old_pos[k]
+            || new_pos[k] != m.new_pos[k])
+            return false;
+    return true;
+}
+
+bool EjectionChain::operator!=(const EjectionChain &m) const {
+    return !(operator==(m));
+}
+
+std::ostream& operator<<(std::ostream &os, const CompositeMove &mv) {
+    if (mv.kind == CompositeMove::INS_MOVE)
+        os << "ins " << mv.ins;
+    else if (mv.kind == CompositeMove::INTER_SWAP)
+        os << "inter " << mv.inter;
+    else
+        os << "intra " << mv.intra;
+    return os;
+}
+
+bool CompositeMove::operator==(const CompositeMove &m) const {
+    if (kind != m.kind)
+        return false;
+    if (kind == INS_MOVE)
+        return ins == m.ins;
+    if (kind == INTER_SWAP)
+        return inter == m.inter;
+    return intra == m.intra;
+}
+
+bool CompositeMove::operator!=(const CompositeMove &m) const {
+    return !(operator==(m));
+}
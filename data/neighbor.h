@@ -45,4 +45,88 @@ class IntraSwap {
     unsigned pos1, pos2;
 };
 
+// Reversal of the stops from pos1 to pos2 of a route, pos1 < pos2;
+// ord1 and ord2 are the groups at the two ends before the move.
+class TwoOptMove {
+    friend std::ostream& operator<<(std::ostream&, const TwoOptMove&);
+ public:
+    bool operator==(const TwoOptMove&) const;
+    bool operator!=(const TwoOptMove&) const;
+    unsigned ord1, ord2, route;
+    unsigned pos1, pos2;
+};
+
+// Relocation of a segment of 1 to kMaxLen consecutive order groups,
+// kept in order; new_pos counts positions in the new route once the
+// segment has left it, so within a route it must differ from old_pos.
+class OrOptMove {
+    friend std::ostream& operator<<(std::ostream&, const OrOptMove&);
+ public:
+    static const unsigned kMaxLen = 3;
+    bool operator==(const OrOptMove&) const;
+    bool operator!=(const OrOptMove&) const;
+    unsigned len;
+    unsigned orders[kMaxLen];   // the first len are meaningful
+    unsigned old_route, old_pos;
+    unsigned new_route, new_pos;
+};
+
+// Exchange of the segment [pos1, pos1 + len1) of route1 with the
+// segment [pos2, pos2 + len2) of route2, two routes of one day. Either
+// segment may be empty; segments running to the end of both routes make
+// a tail exchange (2-opt*). ord1 and ord2 are the groups at the cuts,
+// -1 at the end of a route.
+class CrossExchange {
+    friend std::ostream& operator<<(std::ostream&, const CrossExchange&);
+ public:
+    static const unsigned kMaxLen = 3;  // longest segment short of a tail
+    bool operator==(const CrossExchange&) const;
+    bool operator!=(const CrossExchange&) const;
+    int ord1, ord2;
+    unsigned route1, pos1, len1;
+    unsigned route2, pos2, len2;
+};
+
+// Exchange of the whole contents of two scheduled routes, either of
+// which may be empty: the groups change vehicle, and maybe day, as one.
+class RouteSwap {
+    friend std::ostream& operator<<(std::ostream&, const RouteSwap&);
+ public:
+    bool operator==(const RouteSwap&) const;
+    bool operator!=(const RouteSwap&) const;
+    unsigned route1, route2;
+};
+
+// A chain of relocations: orders[0] leaves routes[0] for routes[1] and
+// pushes orders[1] out of it to routes[2], and so on, until
+// orders[depth - 1] lands in routes[depth] without pushing anything out.
+// old_pos[k] is the position of orders[k] in routes[k], new_pos[k] its
+// position in routes[k + 1] once orders[k + 1], if any, has left. The
+// routes all differ and only routes[0] may be the unscheduled list.
+class EjectionChain {
+    friend std::ostream& operator<<(std::ostream&, const EjectionChain&);
+ public:
+    static const unsigned kMaxDepth = 3;
+    bool operator==(const EjectionChain&) const;
+    bool operator!=(const EjectionChain&) const;
+    unsigned depth;
+    unsigned orders[kMaxDepth];     // the first depth are meaningful
+    unsigned routes[kMaxDepth + 1];
+    unsigned old_pos[kMaxDepth], new_pos[kMaxDepth];
+};
+
+// A move of any of the kinds above; only the member of its kind is
+// meaningful.
+class CompositeMove {
+    friend std::ostream& operator<<(std::ostream&, const CompositeMove&);
+ public:
+    enum Kind { INS_MOVE, INTER_SWAP, INTRA_SWAP };
+    bool operator==(const CompositeMove&) const;
+    bool operator!=(const CompositeMove&) const;
+    Kind kind;
+    InsMove ins;
+    InterSwap inter;
+    IntraSwap intra;
+};
+
 #endif
@@ -2,12 +2,6 @@
 #include <utility>
 #include "data/order.h"
 
-std::istream& operator>>(std::istream &is, Order &o) {
-    is >> o.id >> o.id_client >> o.quantity >> o.mandatory
-       >> o.date_window.first >> o.date_window.second;
-    return is;
-}
-
 std::ostream& operator<<(std::ostream &os, const OrderGroup &og) {
     os << "Mand:" << og.mandatory << " members: ";
     for (unsigned i = 0; i < og.size(); ++i) {
@@ -1,25 +1,22 @@
 #ifndef _ORDER_H_
 #define _ORDER_H_
 #include <iostream>
-#include <string>
 #include <vector>
 #include <utility>
 
 class Order {
-    friend std::istream& operator>>(std::istream&, Order&);
-
  public:
     Order(): quantity(0), mandatory(0), group(0) { }
     Order(const Order &o):
         id(o.id), id_client(o.id_client), quantity(o.quantity),
         mandatory(o.mandatory), date_window(o.date_window)
         { }
-    Order(std::string id_o, std::string id_cli, unsigned qty, bool m,
+    Order(int id_o, int id_cli, unsigned qty, bool m,
           int rd = 1, int dd = 1):
         id(id_o), id_client(id_cli), quantity(qty), mandatory(m),
         date_window(rd, dd) { }
-    std::string get_id() const { return id; }
-    std::string get_client() const { return id_client; }
+    int get_id() const { return id; }
+    int get_client() const { return id_client; }
     int get_demand() const { return quantity; }
     std::pair<int, int> get_dw() const { return date_window; }
     bool IsMandatory() const { return mandatory; }
@@ -30,7 +27,7 @@ class Order {
     int get_group() const { return group; }
 
  protected:
-    std::string id, id_client;
+    int id, id_client;
     int quantity;
     bool mandatory;
     std::pair<int, int> date_window;
@@ -50,10 +47,10 @@ class OrderGroup : public Order {
     unsigned size() const { return members.size(); }
     void insert(const Order&);
     bool IsGroupCompatible(const Order&) const;
-    std::string& operator[](unsigned i) { return members[i]; }
-    const std::string& operator[](unsigned i) const { return members[i]; }
+    int& operator[](unsigned i) { return members[i]; }
+    const int& operator[](unsigned i) const { return members[i]; }
     OrderGroup& operator=(const OrderGroup&);
  private:
-    std::vector<std::string> members;
+    std::vector<int> members;
 };
 #endif
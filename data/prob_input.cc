@@ -1,324 +1,473 @@
 #include "data/prob_input.h"
 #include <iostream>
-#include <fstream>
+#include <iterator>
 #include <sstream>
+#include <stdexcept>
 #include <string>
-#include <map>
 #include <vector>
 #include <utility>
+#include <unordered_map>
 #include <cassert>
 #include <cmath>
+#include "data/mapped_file.h"
 #include "helpers/billing_cost_component.h"
 
-const int kBufSize = 200;
-
 ProbInput::ProbInput(std::istream &input) {
-    std::string tmp;
-    input >> tmp >> tmp;
-    name = tmp;  // case name
-
-    getline(input, tmp);
-    getline(input, tmp);
-    getline(input, tmp);
-
-    char buffer[kBufSize];
-    input.getline(buffer, kBufSize, ':');
-    input >> num_client;
-    getline(input, tmp);
-
-    input.getline(buffer, kBufSize, ':');
-    input >> num_order;
-    getline(input, tmp);
-
-    input.getline(buffer, kBufSize, ':');
-    input >> num_vehicle;
-    getline(input, tmp);
-
-    input.getline(buffer, kBufSize, ':');
-    input >> num_carrier;
-    getline(input, tmp);
-
-    input.getline(buffer, kBufSize, ':');
-    input >> num_billing;
-    getline(input, tmp);
+    std::string buffer((std::istreambuf_iterator<char>(input)),
+                       std::istreambuf_iterator<char>());
+    TextScanner sc(buffer.data(), buffer.data() + buffer.size(), "<input>");
+    Read(sc);
+}
 
-    input.getline(buffer, kBufSize, ':');
-    input >> num_region;
-    getline(input, tmp);
+ProbInput::ProbInput(const std::string &file) {
+    std::unique_ptr<MappedFile> mf(new MappedFile(file));
+    if (IsCompiled(mf->data(), mf->size())) {
+        image.swap(mf);
+        ReadCompiled(file);
+    } else {
+        TextScanner sc(mf->data(), mf->data() + mf->size(), file);
+        Read(sc);
+    }
+    // what a compile of this instance records, be file text or compiled
+    source = Stamp(file);
+}
 
-    getline(input, tmp);  // EDGE_WEIGHT_TYPE
-    getline(input, tmp);  // EDGE_WEIGHT_FORMAT
+ProbInput::ProbInput(const std::string &file, const std::string &segment) {
+    const int kAttempts = 5;
+    SourceStamp stamp = Stamp(file);
+    std::string compiled;
+    for (int k = 0; k < kAttempts && !image; ++k) {
+        image.reset(MappedFile::OpenShared(segment));
+        if (image && !IsCompiledFrom(image->data(), image->size(), stamp)) {
+            // stale: file was edited or moved, or the format changed;
+            // processes still attached keep their copy
+            image.reset();
+            MappedFile::RemoveShared(segment);
+        }
+        if (!image) {
+            if (compiled.empty()) {
+                std::ostringstream os;
+                ProbInput(file).Compile(os);
+                compiled = os.str();
+            }
+            // NULL if another process got there first, whose segment is
+            // checked in the next attempt
+            image.reset(MappedFile::CreateShared(segment, compiled));
+        }
+    }
+    if (!image)
+        throw std::runtime_error(segment + ": shared segment keeps changing");
+    ReadCompiled(segment);
+}
 
-    input.getline(buffer, kBufSize, ':');
-    input >> plan_horizon.first >> tmp >> plan_horizon.second;
-    getline(input, tmp);
+ProbInput::~ProbInput() {
+    for (unsigned i = 0; i < billing_vec.size(); ++i)
+        delete billing_vec[i];
+    billing_vec.clear();
+    for (unsigned i = 0; i < cost_components.size(); ++i)
+        delete cost_components[i];
+}
 
-    ReadDataSection(input);
-    UpdateReachabilityMap();
+void ProbInput::Read(TextScanner &sc) {
+    ReadHeader(sc);
+    ReadDataSection(sc);
     GroupOrder();
+    UpdateReachabilityMap();
+    UpdateRouteFeasibility();
 }
 
-ProbInput::~ProbInput() {
-    std::map<std::string, Billing*>::iterator map_it;
-    map_it = billing_imap.begin();
-    while (map_it != billing_imap.end()) {
-        delete map_it->second;
-        ++map_it;
+// The header is a list of "KEY: value" lines up to DATA_SECTION.
+// Some instances spell the counters NUMBER_xxx instead of NUM_xxx.
+void ProbInput::ReadHeader(TextScanner &sc) {
+    num_client = num_order = num_vehicle = -1;
+    num_carrier = num_billing = num_region = -1;
+    plan_horizon = std::make_pair(-1, -1);
+    EdgeWeights &ew = edge_weights;
+    ew.type = "EXPLICIT";
+    ew.format = "FULL_MATRIX";
+    ew.has_default = false;
+    ew.speed = 60;
+    ew.road_factor = 1;
+    while (!sc.AtEnd() && !sc.TokenIs("DATA_SECTION")) {
+        std::string line = sc.RestOfLine();
+        size_t colon = line.find(':');
+        if (colon == std::string::npos)
+            sc.Fail("header line without ':' (" + line + ")");
+        std::string key = line.substr(0, colon);
+        while (key.size() && (key.back() == ' ' || key.back() == '\t'))
+            key.pop_back();
+        if (key.compare(0, 7, "NUMBER_") == 0)
+            key = "NUM_" + key.substr(7);
+        const char *b = line.c_str() + colon + 1;
+        const char *e = line.c_str() + line.size();
+        while (b < e && (*b == ' ' || *b == '\t')) ++b;
+        std::string value(b, e);
+        const char *stop;
+        int *counter = NULL;
+        if (key == "NAME") {
+            name = value;
+        } else if (key == "NUM_CLIENTS") {
+            counter = &num_client;
+        } else if (key == "NUM_ORDERS") {
+            counter = &num_order;
+        } else if (key == "NUM_VEHICLES") {
+            counter = &num_vehicle;
+        } else if (key == "NUM_CARRIERS") {
+            counter = &num_carrier;
+        } else if (key == "NUM_BILLINGS") {
+            counter = &num_billing;
+        } else if (key == "NUM_REGIONS") {
+            counter = &num_region;
+        } else if (key == "EDGE_WEIGHT_TYPE") {
+            ew.type = value;
+        } else if (key == "EDGE_WEIGHT_FORMAT") {
+            ew.format = value;
+        } else if (key == "DEFAULT_EDGE") {  // km sec
+            ew.default_km = ParseDecimal(b, e, &stop);
+            const char *b2 = stop;
+            while (b2 < e && (*b2 == ' ' || *b2 == '\t')) ++b2;
+            ew.default_sec = ParseInt(b2, e, &stop);
+            if (stop == b2 || ew.default_km < 0 || ew.default_sec < 0)
+                sc.Fail("bad DEFAULT_EDGE '" + value + "'");
+            ew.has_default = true;
+        } else if (key == "SPEED") {
+            ew.speed = ParseDecimal(b, e, &stop);
+            if (stop == b || ew.speed <= 0)
+                sc.Fail("bad SPEED '" + value + "'");
+        } else if (key == "ROAD_FACTOR") {
+            ew.road_factor = ParseDecimal(b, e, &stop);
+            if (stop == b || ew.road_factor <= 0)
+                sc.Fail("bad ROAD_FACTOR '" + value + "'");
+        } else if (key == "PLAN_HORIZON") {  // first - last;
+            plan_horizon.first = ParseInt(b, e, &stop);
+            if (stop == b)
+                sc.Fail("bad PLAN_HORIZON '" + value + "'");
+            while (stop < e && (*stop == ' ' || *stop == '-')) ++stop;
+            b = stop;
+            plan_horizon.second = ParseInt(b, e, &stop);
+            if (stop == b || plan_horizon.first < 1
+                || plan_horizon.second < plan_horizon.first)
+                sc.Fail("bad PLAN_HORIZON '" + value + "'");
+        }
+        // TYPE, COMMENT and unknown keys are ignored
+        if (counter) {
+            *counter = ParseInt(b, e, &stop);
+            if (stop == b || *counter < 0)
+                sc.Fail("bad value for " + key + " '" + value + "'");
+        }
     }
-    billing_imap.clear();
+    if (num_client <= 0 || num_order <= 0 || num_vehicle <= 0 ||
+        num_carrier <= 0 || num_billing <= 0 || num_region <= 0)
+        sc.Fail("header lacks one of the NUM_xxx counters");
+    if (plan_horizon.first < 0)
+        sc.Fail("header lacks PLAN_HORIZON");
+    if ((ew.type != "EXPLICIT" && ew.type != "EUC_2D" && ew.type != "GEO") ||
+        (ew.format != "FULL_MATRIX" && ew.format != "EDGE_LIST"))
+        sc.Fail("unsupported edge weights " + ew.type + "/" + ew.format);
+    if (ew.type == "EXPLICIT" && ew.format == "EDGE_LIST" && !ew.has_default)
+        sc.Fail("an EXPLICIT EDGE_LIST needs DEFAULT_EDGE");
 }
 
-void ProbInput::ReadDataSection(std::istream &input) {
-    std::string tmp;
-    input >> tmp;
-    input >> tmp >> tmp;
-    input >> depot_id;
-    input >> tmp >> tmp;
+void ProbInput::ReadDataSection(TextScanner &sc) {
+    std::string depot, id1, id2;
+    sc.Expect("DATA_SECTION");
+    sc.Expect("DEPOT_SECTION");
+    sc.SkipLine();
+    sc.Token(depot);
+    sc.Expect("REGIONS");
+    sc.SkipLine();
     // REGIONS
     for (int i = 0; i < num_region; ++i) {
-        input >> tmp;
-        region_imap[tmp] = i;
+        sc.Token(id1);
+        if (region_symbols.Intern(id1) != i)
+            sc.Fail("duplicate region " + id1);
     }
 
     // BILLINGS
-    CreateBillingStategy(input);
+    CreateBillingStategy(sc);
 
-    std::string id1, id2;
     // CARRIERS
-    input >> tmp >> tmp;
-    site_map.resize(num_carrier, std::vector<bool>(num_region, true));
+    sc.Expect("CARRIERS");
+    sc.SkipLine();
+    site_map.Assign(num_carrier, num_region, true);
     for (int i = 0; i < num_carrier; ++i) {
-        int num_incompatible_regions;
-        input >> id1 >> id2 >> num_incompatible_regions;
-        std::string region_id;
+        sc.Token(id1);
+        sc.Token(id2);
+        int num_incompatible_regions = sc.Int("incompatible regions");
         for (int j = 0; j < num_incompatible_regions; ++j) {
-            input >> region_id;
-            int region_ind = region_imap[region_id];
-            assert(region_ind < num_region);
-            site_map[i][region_ind] = false;
+            std::string region_id = sc.Token();
+            int region_ind = IndexRegion(region_id);
+            if (region_ind < 0)
+                sc.Fail("carrier " + id1 + ": unknown region " + region_id);
+            site_map.Set(i, region_ind, false);
         }
-        carrier_vec.push_back(Carrier(id1, id2));
-        carrier_imap[id1] = i;
+        int billing_ind = billing_symbols.Find(id2);
+        if (billing_ind < 0)
+            sc.Fail("carrier " + id1 + ": unknown billing " + id2);
+        if (carrier_symbols.Intern(id1) != i)
+            sc.Fail("duplicate carrier " + id1);
+        carrier_vec.push_back(Carrier(i, billing_ind));
     }
 
     // VEHICLES
-    input >> tmp >> tmp;
-    vehicle_vec.resize(num_vehicle);
-    for (int i = 0; i < num_vehicle; ++i)
-        input >> vehicle_vec[i];
+    sc.Expect("VEHICLES");
+    sc.SkipLine();
+    vehicle_vec.reserve(num_vehicle);
+    for (int i = 0; i < num_vehicle; ++i) {
+        sc.Token(id1);
+        long cap = sc.Int("vehicle capacity");
+        long fixed_cost = sc.Int("vehicle cost");
+        sc.Token(id2);
+        int carrier_ind = FindCarrier(id2);
+        if (carrier_ind < 0)
+            sc.Fail("vehicle " + id1 + ": unknown carrier " + id2);
+        if (cap < 0 || fixed_cost < 0)
+            sc.Fail("vehicle " + id1 + ": negative capacity or cost");
+        if (vehicle_symbols.Intern(id1) != i)
+            sc.Fail("duplicate vehicle " + id1);
+        vehicle_vec.push_back(Vehicle(i, carrier_ind, cap, fixed_cost * 1000));
+    }
 
     // CLIENTS
-    input >> tmp >> tmp;
-    client_vec.resize(num_client);
+    sc.Expect("CLIENTS");
+    sc.SkipLine();
+    client_vec.reserve(num_client);
     for (int i = 0; i < num_client; ++i) {
-        input >> client_vec[i];
-        client_imap[client_vec[i].get_id()] = i;
+        sc.Token(id1);
+        sc.Token(id2);
+        int ready_time = sc.Int("ready time");
+        int due_time = sc.Int("due time");
+        int serv_time = sc.Int("service time");
+        int region_ind = IndexRegion(id2);
+        if (region_ind < 0)
+            sc.Fail("client " + id1 + ": unknown region " + id2);
+        if (client_symbols.Intern(id1) != i)
+            sc.Fail("duplicate client " + id1);
+        client_vec.push_back(Client(i, region_ind, ready_time, due_time,
+                                    serv_time));
     }
+    depot_id = IndexClient(depot);
+    if (depot_id < 0)
+        sc.Fail("depot " + depot + " is not a client");
 
     // ORDERS
-    input >> tmp >> tmp;
-    order_vec.resize(num_order);
+    sc.Expect("ORDERS");
+    sc.SkipLine();
+    order_vec.reserve(num_order);
     for (int i = 0; i < num_order; ++i) {
-        input >> order_vec[i];
-        order_imap[order_vec[i].get_id()] = i;
+        sc.Token(id1);
+        sc.Token(id2);
+        long qty = sc.Int("order quantity");
+        long mandatory = sc.Int("mandatory flag");
+        int ready_date = sc.Int("ready date");
+        int due_date = sc.Int("due date");
+        int client_ind = IndexClient(id2);
+        if (client_ind < 0)
+            sc.Fail("order " + id1 + ": unknown client " + id2);
+        if (qty < 0 || (mandatory != 0 && mandatory != 1))
+            sc.Fail("order " + id1 + ": bad quantity or mandatory flag");
+        if (ready_date < 1 || due_date < ready_date)
+            sc.Fail("order " + id1 + ": bad date window");
+        if (order_symbols.Intern(id1) != i)
+            sc.Fail("duplicate order " + id1);
+        order_vec.push_back(Order(i, client_ind, qty, mandatory,
+                                  ready_date, due_date));
     }
 
 
     // EDGES
-    input >> tmp >> tmp;
-    getline(input, tmp);
-    distance.resize(num_client, std::vector<int>(num_client, -1));
-    time_dist.resize(num_client, std::vector<int>(num_client, -1));
-    while (getline(input, tmp)) {
-        if (tmp == "END") break;
-        std::istringstream ss(tmp);
-        double dist_km;
-        int dist_sec, ind1, ind2;
-        ss >> id1 >> id2 >> dist_km >> dist_sec;
-        ind1 = IndexClient(id1);
-        ind2 = IndexClient(id2);
+    ReadEdges(sc);
+}
+
+void ProbInput::CreateCostComponents() {
+    int weight = 1;
+    cost_components.push_back(new DistanceBillingCostComponent(*this,
+                                                               weight));
+    cost_components.push_back(new DistanceLoadBillingCostComponent(*this,
+                                                                   weight));
+    cost_components.push_back(new LoadRangeBillingCostComponent(*this,
+                                                                weight));
+    cost_components.push_back(new LoadFarestClientCostComponent(*this,
+                                                                weight));
+    cost_components.push_back(new LoadClientDependentCostComponent(*this,
+                                                                   weight));
+}
 
-        // std::cout << id1 << ':' << ind1 << ','
-        //           << id2 << ':' << ind2 << std::endl;
-        assert(ind1 >= 0 && ind1 < num_client);
-        assert(ind2 >= 0 && ind2 < num_client);
-        distance[ind1][ind2] = static_cast<unsigned>(dist_km + 0.5);
-        time_dist[ind1][ind2] = dist_sec;
+// type is the number of the cost function, 1 (bt1) to 5 (bt5)
+Billing* ProbInput::NewBilling(int id, int type) const {
+    Billing *b = NULL;
+    switch (type) {
+        case 1: b = new KmBilling(id, type, 0); break;
+        case 2: b = new LoadKmBilling(id, type); break;
+        case 3: b = new VarLoadBilling(id, type); break;
+        case 4:
+        case 5: b = new LoadBilling(id, type); break;
+        default: return NULL;
     }
+    b->SetCostComponent(cost_components[type - 1]);
+    return b;
 }
 
-void ProbInput::CreateBillingStategy(std::istream &input) {
-    int weight = 1;
-    DistanceBillingCostComponent* dcc =
-        new DistanceBillingCostComponent(*this, weight);
-    DistanceLoadBillingCostComponent* dlcc =
-        new DistanceLoadBillingCostComponent(*this, weight);
-    LoadRangeBillingCostComponent* lrcc =
-        new LoadRangeBillingCostComponent(*this, weight);
-    LoadFarestClientCostComponent* lfcc =
-        new LoadFarestClientCostComponent(*this, weight);
-    LoadClientDependentCostComponent* lcc =
-        new LoadClientDependentCostComponent(*this, weight);
+void ProbInput::CreateBillingStategy(TextScanner &sc) {
+    CreateCostComponents();
 
-    double n;
-    std::string tmp, id, type;
-    char buffer[kBufSize];
-    input >> tmp;
+    std::string id, type;
+    sc.Expect("BILLINGS_DATA:");
+    sc.SkipLine();
+    billing_vec.reserve(num_billing);
     for (int i = 0; i < num_billing; ++i) {
-        input >> id >> type;
-        input.getline(buffer, kBufSize);
+        sc.Token(id);
+        sc.Token(type);
+        sc.SkipLine();
+        if (billing_symbols.Intern(id) != i)
+            sc.Fail("duplicate billing " + id);
+        Billing *b = NULL;
         if (type == "bt1") {
-            input >> n;
+            double n = sc.Decimal("km rate");
             unsigned rate = static_cast<unsigned>(ceil(n*1000));
-            KmBilling *kmc = new KmBilling(id, type, rate);
-            kmc->SetCostComponent(dcc);
-            billing_imap[id] = kmc;
+            b = new KmBilling(i, 1, rate);
+            b->SetCostComponent(cost_components[0]);
         } else if (type == "bt2") {
-            LoadKmBilling *lkc = new LoadKmBilling(id, type);
-            lkc->ReadInputData(input, num_region);
-            lkc->SetCostComponent(dlcc);
-            billing_imap[id] = lkc;
+            LoadKmBilling *lkc = static_cast<LoadKmBilling*>(NewBilling(i, 2));
+            lkc->ReadInputData(sc, num_region);
+            b = lkc;
         } else if (type == "bt3") {
-            VarLoadBilling *vlc = new VarLoadBilling(id, type);
-            vlc->ReadInputData(input, num_region);
-            vlc->SetCostComponent(lrcc);
-            billing_imap[id] = vlc;
-        } else if (type == "bt4") {
-            LoadBilling *lfc = new LoadBilling(id, type);
-            lfc->ReadInputData(input, num_region);
-            lfc->SetCostComponent(lfcc);
-            billing_imap[id] = lfc;
-        } else if (type == "bt5") {
-            LoadBilling *ldc = new LoadBilling(id, type);
-            ldc->ReadInputData(input, num_region);
-            ldc->SetCostComponent(lcc);
-            billing_imap[id] = ldc;
+            VarLoadBilling *vlc =
+                static_cast<VarLoadBilling*>(NewBilling(i, 3));
+            vlc->ReadInputData(sc, num_region);
+            b = vlc;
+        } else if (type == "bt4" || type == "bt5") {
+            LoadBilling *lc = static_cast<LoadBilling*>(
+                NewBilling(i, type == "bt4" ? 4 : 5));
+            lc->ReadInputData(sc, num_region);
+            b = lc;
         } else {
-            std::cout << "Billing type not implemented" << std::endl;
-            assert(false);
+            sc.Fail("billing " + id + ": type " + type + " not implemented");
         }
+        billing_vec.push_back(b);
     }
 }
 
+// Orders of the same client with the same mandatory flag and date
+// window are merged into groups, first fit, as long as the group still
+// fits the largest vehicle able to reach it. Candidate groups are found
+// by hashing that key, so grouping is linear in the number of orders.
 void ProbInput::GroupOrder() {
-    bool add = false;
-    OrderGroup og(order_vec[0]);
-    ordergroup_vec.push_back(og);
-    for (int i = 1; i < num_order; ++i) {
-        int og_size = ordergroup_vec.size();
-        for (int j = 0; j < og_size; ++j) {
-            if (ordergroup_vec[j].IsGroupCompatible(order_vec[i])) {
-                int group_qty = ordergroup_vec[j].get_demand();
-                int max_cap = get_maxcap_for_order(i);
-                if (group_qty +  order_vec[i].get_demand() <= max_cap) {
-                    ordergroup_vec[j].insert(order_vec[i]);
-                    order_vec[i].set_group(j);
-                    add = true;
-                }
-            }
+    PrecomputeMaxCap();
+    std::unordered_map<GroupKey, std::vector<int>, GroupKeyHash> open;
+    ordergroup_vec.reserve(num_order);
+    for (int i = 0; i < num_order; ++i) {
+        const Order &o = order_vec[i];
+        GroupKey key = { o.get_client(), o.IsMandatory(),
+                         o.get_dw().first, o.get_dw().second };
+        std::vector<int> &candidates = open[key];
+        int max_cap = get_maxcap_for_order(i);
+        int g = -1;
+        for (unsigned k = 0; k < candidates.size() && g < 0; ++k) {
+            const OrderGroup &og = ordergroup_vec[candidates[k]];
+            if (og.get_demand() + o.get_demand() <= max_cap)
+                g = candidates[k];
         }
-        if (!add) {
-            ordergroup_vec.push_back(OrderGroup(order_vec[i]));
-            order_vec[i].set_group(ordergroup_vec.size() - 1);
+        if (g >= 0) {
+            ordergroup_vec[g].insert(o);
+        } else {
+            g = ordergroup_vec.size();
+            ordergroup_vec.push_back(OrderGroup(o));
+            candidates.push_back(g);
         }
-        add = false;
+        order_vec[i].set_group(g);
     }
 }
 
-int ProbInput::get_maxcap_for_order(int o) const {
-    unsigned max = 0;
+// The largest vehicle reaching an order only depends on the region of
+// its client.
+void ProbInput::PrecomputeMaxCap() {
+    std::vector<int> region_cap(num_region, 0);
     for (int k = 0; k < num_vehicle; ++k) {
-        if (IsReachable(k, o)) {
-            if (max < vehicle_vec[k].get_cap())
-                max = vehicle_vec[k].get_cap();
-        }
+        int cr_index = vehicle_vec[k].get_carrier();
+        int cap = vehicle_vec[k].get_cap();
+        for (int r = 0; r < num_region; ++r)
+            if (site_map.Test(cr_index, r) && region_cap[r] < cap)
+                region_cap[r] = cap;
     }
-    return max;
-}
-
-int ProbInput::get_distance(const std::string &cli_from,
-                             const std::string &cli_to) const {
-    int id_from = IndexClient(cli_from);
-    int id_to = IndexClient(cli_to);
-    assert(id_from < num_client && id_to < num_client);
-    return distance[id_from][id_to];
-}
-
-int ProbInput::get_time_dist(const std::string &cli_from,
-                              const std::string &cli_to) const {
-    int id_from = IndexClient(cli_from);
-    int id_to = IndexClient(cli_to);
-    assert(id_from < num_client && id_to < num_client);
-    return time_dist[id_from][id_to];
+    order_maxcap.resize(num_order);
+    for (int i = 0; i < num_order; ++i)
+        order_maxcap[i] =
+            region_cap[FindClient(order_vec[i].get_client()).get_region()];
 }
 
 int ProbInput::IndexRegion(const std::string &region_id) const {
-    std::map<std::string, int>::const_iterator it;
-    it = region_imap.find(region_id);
-    if (it != region_imap.end())
-        return it->second;
-    return -1;  // not found
+    return region_symbols.Find(region_id);
 }
 
 int ProbInput::FindCarrier(const std::string &carrier_id) const {
-    std::map<std::string, int>::const_iterator it;
-    it = carrier_imap.find(carrier_id);
-    if (it != carrier_imap.end())
-        return it->second;
-    return -1;  // not found
+    return carrier_symbols.Find(carrier_id);
 }
 
 int ProbInput::IndexOrderGroup(const std::string &order_id) const {
-    std::map<std::string, int>::const_iterator it;
-    it = order_imap.find(order_id);
-    if (it != order_imap.end())
-        return order_vec[it->second].get_group();
+    int o = order_symbols.Find(order_id);
+    if (o >= 0)
+        return order_vec[o].get_group();
     return -1;
 }
 
 int ProbInput::IndexClient(const std::string &client_id) const {
-    std::map<std::string, int>::const_iterator it;
-    it = client_imap.find(client_id);
-    if (it != client_imap.end())
-        return it->second;
-    return -1;
-}
-
-const Client& ProbInput::FindClient(const std::string &client_id) const {
-    int c = IndexClient(client_id);
-    return client_vec[c];
+    return client_symbols.Find(client_id);
 }
 
 const Billing* ProbInput::FindBilling(int vehicle) const {
-    int cr_index = FindCarrier(vehicle_vec[vehicle].get_carrier());
-    std::map<std::string, Billing*>::const_iterator it;
-    it = billing_imap.find(carrier_vec[cr_index].get_billing());
-    if (it != billing_imap.end())
-        return it->second;
-    return NULL;
+    int cr_index = vehicle_vec[vehicle].get_carrier();
+    return billing_vec[carrier_vec[cr_index].get_billing()];
 }
 
+// Reachability only depends on the carrier of the vehicle and on the
+// region of the client, so one vehicle mask per region is built from the
+// carrier site maps and copied word by word to the groups of the region.
 void ProbInput::UpdateReachabilityMap() {
-    rmap.resize(num_vehicle, std::vector<bool>(num_order, true));
-    for (int i = 0; i < num_vehicle; ++i) {
-        for (int j = 0; j < num_order; ++j) {
-            int cr_index = FindCarrier(vehicle_vec[i].get_carrier());
-            std::string client_id = order_vec[j].get_client();
-            int r_index = IndexRegion(FindClient(client_id).get_region());
-            assert(cr_index < num_carrier && r_index < num_region);
-            rmap[i][j] = site_map[cr_index][r_index];
+    BitTable region_vehicles;
+    region_vehicles.Assign(num_region, num_vehicle, false);
+    for (int v = 0; v < num_vehicle; ++v) {
+        int cr_index = vehicle_vec[v].get_carrier();
+        for (int r = 0; r < num_region; ++r)
+            if (site_map.Test(cr_index, r))
+                region_vehicles.Set(r, v, true);
+    }
+    int num_og = get_num_ogroup();
+    int words = get_vehicle_words();
+    group_vehicles.Assign(num_og, num_vehicle, false);
+    vehicle_groups.Assign(num_vehicle, num_og, false);
+    for (int g = 0; g < num_og; ++g) {
+        int r = FindClient(ordergroup_vec[g].get_client()).get_region();
+        const uint64_t *mask = region_vehicles.row(r);
+        uint64_t *row = group_vehicles.mutable_row(g);
+        for (int w = 0; w < words; ++w) {
+            row[w] = mask[w];
+            for (uint64_t bits = mask[w]; bits; bits &= bits - 1)
+                vehicle_groups.Set(w * 64 + LowestBit(bits), g, true);
         }
     }
 }
 
-bool ProbInput::IsReachable(int v, int o) const {
-    assert(v < num_vehicle && o < num_order);
-    return rmap[v][o];
+void ProbInput::UpdateRouteFeasibility() {
+    int num_og = get_num_ogroup();
+    int num_day = get_dayspan();
+    group_fits.Assign(num_og, num_vehicle, false);
+    date_penalty.Assign(num_og, num_day + 1, 0);
+    for (int g = 0; g < num_og; ++g) {
+        const OrderGroup &og = ordergroup_vec[g];
+        for (int v = 0; v < num_vehicle; ++v)
+            if (IsReachable(v, g) &&
+                static_cast<unsigned>(og.get_demand()) <=
+                vehicle_vec[v].get_cap())
+                group_fits.Set(g, v, true);
+        for (int d = 0; d < num_day; ++d)
+            date_penalty.at(g, d) = og.IsDayFeasible(d) ? 0 : og.get_demand();
+    }
 }
 
 bool ProbInput::IsReachable(const Vehicle &v, const Order &o) const {
-    int cr_index = FindCarrier(v.get_carrier());
-    int r_index = IndexRegion(FindClient(o.get_client()).get_region());
+    int cr_index = v.get_carrier();
+    int r_index = FindClient(o.get_client()).get_region();
     assert(cr_index < num_carrier && r_index < num_region);
-    return site_map[cr_index][r_index];
+    return site_map.Test(cr_index, r_index);
 }
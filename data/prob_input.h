@@ -4,29 +4,55 @@
 #include <fstream>
 #include <vector>
 #include <string>
-#include <map>
 #include <utility>
 #include <cassert>
+#include <memory>
+#include <stdint.h>
 #include "data/carrier.h"
 #include "data/vehicle.h"
 #include "data/client.h"
 #include "data/order.h"
 #include "data/billing.h"
+#include "data/symbol_table.h"
+#include "data/text_scanner.h"
+#include "data/binary_io.h"
+#include "data/flat_table.h"
+#include "data/arc_matrix.h"
+
+class MappedFile;
 
 
 // Deal with problem input
 class ProbInput {
  public:
     // ignore VRPPC temporarily
-    ProbInput(std::istream&);
+    // Malformed input throws std::runtime_error (file:line: reason).
+    explicit ProbInput(std::istream&);
+    // .vrp text or compiled instance, memory-mapped
+    explicit ProbInput(const std::string &file);
+    // Compiled instance published in the named POSIX shared-memory
+    // segment; the first process creates it from file. The matrices and
+    // reachability maps are read in place, so every process attached to
+    // the segment shares one physical copy of them. A segment built from
+    // another file, another version of it or another compiled format is
+    // replaced.
+    ProbInput(const std::string &file, const std::string &segment);
     ~ProbInput();
+    // Write the parsed instance as a compiled (.vrpb) file that loads
+    // without parsing, grouping or reachability computation.
+    void Compile(const std::string &file) const;
+    void Compile(std::ostream&) const;
+    static bool IsCompiled(const char *data, size_t size);
     int IndexRegion(const std::string&) const;
     int FindCarrier(const std::string&) const;
     int IndexClient(const std::string&) const;
     int IndexOrderGroup(const std::string&) const;
-    const Client& FindClient(const std::string&) const;
+    const Client& FindClient(int c) const {
+        assert(c < num_client && c >= 0);
+        return client_vec[c];
+    }
     const Billing* FindBilling(int v) const;
-    std::string get_depot() const { return depot_id; }
+    int get_depot() const { return depot_id; }
     int get_num_client() const { return num_client; }
     int get_num_order() const { return num_order; }
     int get_num_ogroup() const { return ordergroup_vec.size(); }
@@ -46,6 +72,10 @@ class ProbInput {
         assert(i < num_vehicle && i >= 0);
         return vehicle_vec[i];
     }
+    // ids are only kept for the output
+    const std::string& ClientName(int c) const { return client_symbols.Name(c); }
+    const std::string& OrderName(int o) const { return order_symbols.Name(o); }
+    const std::string& VehicleName(int v) const { return vehicle_symbols.Name(v); }
     int get_dayspan() const {
         return plan_horizon.second - plan_horizon.first + 1;
     }
@@ -56,18 +86,106 @@ class ProbInput {
         return FindClient(depot_id).get_due_time();
     }
     const std::pair<int, int>& get_plan_horizon() const { return plan_horizon; }
-    int get_distance(const std::string&, const std::string&) const;
-    int get_time_dist(const std::string&, const std::string&) const;
-    bool IsReachable(int, int) const;
+    int get_distance(int cli_from, int cli_to) const {
+        return arcs.distance(cli_from, cli_to);
+    }
+    int get_time_dist(int cli_from, int cli_to) const {
+        return arcs.time(cli_from, cli_to);
+    }
+    // both at once, one memory access
+    ArcMatrix::Arc get_arc(int cli_from, int cli_to) const {
+        return arcs.arc(cli_from, cli_to);
+    }
+    // vehicle v may serve order group og
+    bool IsReachable(int v, int og) const {
+        return group_vehicles.Test(og, v);
+    }
     bool IsReachable(const Vehicle&, const Order&) const;
+    // Admissible vehicles of a group and reachable groups of a vehicle as
+    // bit masks of get_vehicle_words() / get_group_words() 64-bit words;
+    // walk them with LowestBit.
+    const uint64_t* AdmissibleVehicles(int og) const {
+        return group_vehicles.row(og);
+    }
+    const uint64_t* ReachableGroups(int v) const {
+        return vehicle_groups.row(v);
+    }
+    // Static part of placing order group og on route day*V+v (the last
+    // route being the unscheduled list): whether the vehicle reaches the
+    // group and can carry it at all, and the unweighted date violation.
+    // Both only depend on og and one of day or v, so the cube is kept as
+    // a group x vehicle and a group x day table.
+    bool IsAdmissible(int og, int route) const {
+        int day = route / num_vehicle;
+        if (day == get_dayspan())
+            return !ordergroup_vec[og].IsMandatory();
+        return group_fits.Test(og, route % num_vehicle);
+    }
+    int DatePenalty(int og, int route) const {
+        return date_penalty(og, route / num_vehicle);
+    }
+    // admissible vehicles whose capacity is at least the group demand
+    const uint64_t* FittingVehicles(int og) const {
+        return group_fits.row(og);
+    }
+    int get_vehicle_words() const { return BitTable::WordsFor(num_vehicle); }
+    int get_group_words() const {
+        return BitTable::WordsFor(get_num_ogroup());
+    }
 
  private:
-    void ReadDataSection(std::istream&);
-    void CreateBillingStategy(std::istream&);
+    void Read(TextScanner&);
+    void ReadHeader(TextScanner&);
+    void ReadDataSection(TextScanner&);
+    void ReadEdges(TextScanner&);
+    void ComputeEdges(const std::vector<double> &x,
+                      const std::vector<double> &y,
+                      FlatTable<int> &distance,
+                      FlatTable<int> &time_dist) const;
+    void CreateBillingStategy(TextScanner&);
+    void CreateCostComponents();
+    Billing* NewBilling(int id, int type) const;
+    void ReadCompiled(const std::string &source);
+    void ReadCompiled(BinaryReader&);
+    // the file an instance was read from, as compiled images record it
+    struct SourceStamp {
+        SourceStamp(): size(0), mtime(0) { }
+        std::string path;   // canonical
+        uint64_t size;
+        int64_t mtime;      // ns
+        bool operator==(const SourceStamp &s) const {
+            return path == s.path && size == s.size && mtime == s.mtime;
+        }
+    };
+    // empty path if file cannot be looked up
+    static SourceStamp Stamp(const std::string &file);
+    // whether data is a compiled image of this format from source
+    static bool IsCompiledFrom(const char *data, size_t size,
+                               const SourceStamp &source);
     void UpdateReachabilityMap();
+    void UpdateRouteFeasibility();
     void GroupOrder();
-    int get_maxcap_for_order(int) const;
-    std::string name, depot_id;
+    void PrecomputeMaxCap();
+    int get_maxcap_for_order(int o) const { return order_maxcap[o]; }
+    struct GroupKey {
+        int client;
+        bool mandatory;
+        int ready_date, due_date;
+        bool operator==(const GroupKey &k) const {
+            return client == k.client && mandatory == k.mandatory &&
+                   ready_date == k.ready_date && due_date == k.due_date;
+        }
+    };
+    struct GroupKeyHash {
+        size_t operator()(const GroupKey &k) const {
+            size_t h = k.client;
+            h = h * 2 + k.mandatory;
+            h = h * 1000003 + k.ready_date;
+            return h * 1000003 + k.due_date;
+        }
+    };
+    std::string name;
+    int depot_id;
     int num_client;
     int num_vehicle;
     int num_order;
@@ -76,25 +194,49 @@ class ProbInput {
     int num_billing;
     std::pair<int, int> plan_horizon;
 
+    // How the header says arcs are weighted; only used while reading.
+    // EUC_2D (km) and GEO (degrees) give a NODE_COORD_SECTION and derive
+    // the arcs from it with the speed model, an EDGE_LIST gives only
+    // some arcs and the others fall back to the coordinates or to
+    // DEFAULT_EDGE.
+    struct EdgeWeights {
+        std::string type;    // EXPLICIT, EUC_2D or GEO
+        std::string format;  // FULL_MATRIX or EDGE_LIST
+        bool has_default;
+        double default_km;
+        int default_sec;
+        double speed;  // km/h
+        double road_factor;  // road over straight-line distance
+    } edge_weights;
+
     // Data section
     std::vector<Carrier> carrier_vec;
     std::vector<Vehicle> vehicle_vec;
     std::vector<Client> client_vec;
     std::vector<Order> order_vec;
     std::vector<OrderGroup> ordergroup_vec;
-    // std::vector<Billing*> billing_vec;
+    std::vector<int> order_maxcap;  // largest vehicle reaching the order
+    std::vector<Billing*> billing_vec;
+    std::vector<BillingCostComponent*> cost_components;  // by billing type
+
+    ArcMatrix arcs;  // distance in km, time in seconds
 
-    std::vector<std::vector<int> > distance;  // in meters
-    std::vector<std::vector<int> > time_dist;  // in seconds
+    // Id handles, the handle of an object is its index in the vectors above
+    SymbolTable region_symbols;
+    SymbolTable client_symbols;
+    SymbolTable order_symbols;
+    SymbolTable carrier_symbols;
+    SymbolTable vehicle_symbols;
+    SymbolTable billing_symbols;
 
-    // Id maps
-    std::map<std::string, int> region_imap;
-    std::map<std::string, int> client_imap;
-    std::map<std::string, int> order_imap;
-    std::map<std::string, int> carrier_imap;
-    std::map<std::string, Billing*> billing_imap;
+    BitTable site_map;  // carrier x region
+    BitTable group_vehicles;  // order group x vehicle
+    BitTable vehicle_groups;  // vehicle x order group
+    BitTable group_fits;  // order group x vehicle
+    FlatTable<int> date_penalty;  // order group x (day, unscheduled)
 
-    std::vector<std::vector<bool> > site_map;
-    std::vector<std::vector<bool> > rmap;
+    // compiled image the tables above may point into
+    std::unique_ptr<MappedFile> image;
+    SourceStamp source;
 };
 #endif
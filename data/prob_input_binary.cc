@@ -0,0 +1,376 @@
+// Compiled instances (.vrpb): everything ProbInput derives from a .vrp
+// file, written as raw native-endian arrays. Loading one is a handful of
+// memcpy's out of the mapping; no parsing, order grouping or
+// reachability computation is redone. The matrices and reachability
+// maps are not copied at all, they are read in place.
+#include "data/prob_input.h"
+#include <sys/stat.h>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+#include "data/mapped_file.h"
+
+namespace {
+
+const char kMagic[4] = { 'V', 'R', 'P', 'B' };
+const uint32_t kVersion = 6;
+const uint32_t kByteOrder = 0x01020304;
+
+void WriteSymbols(BinaryWriter &w, const SymbolTable &st) {
+    w.Pod(static_cast<uint32_t>(st.size()));
+    for (int i = 0; i < st.size(); ++i)
+        w.String(st.Name(i));
+}
+
+void ReadSymbols(BinaryReader &r, SymbolTable &st, int expected) {
+    uint32_t n = r.Pod<uint32_t>();
+    if (static_cast<int>(n) != expected)
+        r.Fail("symbol table does not match the header");
+    for (uint32_t i = 0; i < n; ++i) {
+        if (st.Intern(r.String()) != static_cast<int>(i))
+            r.Fail("duplicate symbol");
+    }
+}
+
+template <class T>
+void CheckSize(BinaryReader &r, const std::vector<T> &v, int n) {
+    if (static_cast<int>(v.size()) != n)
+        r.Fail("table size does not match the header");
+}
+
+template <class T>
+void CheckRange(BinaryReader &r, const std::vector<T> &v, int n) {
+    for (unsigned i = 0; i < v.size(); ++i)
+        if (v[i] < 0 || v[i] >= n)
+            r.Fail("handle out of range");
+}
+
+}  // namespace
+
+bool ProbInput::IsCompiled(const char *data, size_t size) {
+    return size >= sizeof(kMagic) && !memcmp(data, kMagic, sizeof(kMagic));
+}
+
+ProbInput::SourceStamp ProbInput::Stamp(const std::string &file) {
+    SourceStamp s;
+    char path[PATH_MAX];
+    struct stat st;
+    if (!realpath(file.c_str(), path) || stat(path, &st) != 0)
+        return s;
+    s.path = path;
+    s.size = st.st_size;
+    s.mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    return s;
+}
+
+bool ProbInput::IsCompiledFrom(const char *data, size_t size,
+                               const SourceStamp &source) {
+    if (!IsCompiled(data, size) || source.path.empty())
+        return false;
+    BinaryReader r(data, data + size, "<image>");
+    try {
+        r.View(sizeof(kMagic));
+        if (r.Pod<uint32_t>() != kVersion ||
+            r.Pod<uint32_t>() != kByteOrder)
+            return false;
+        r.Tag("SRCE");
+        SourceStamp s;
+        s.path = r.String();
+        s.size = r.Pod<uint64_t>();
+        s.mtime = r.Pod<int64_t>();
+        return s == source;
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+}
+
+void ProbInput::Compile(const std::string &file) const {
+    std::ofstream os(file.c_str(), std::ios::binary | std::ios::trunc);
+    if (!os.is_open())
+        throw std::runtime_error(file + ": cannot write compiled instance");
+    Compile(os);
+    if (!os)
+        throw std::runtime_error(file + ": write failed");
+}
+
+void ProbInput::Compile(std::ostream &os) const {
+    BinaryWriter w(os);
+    w.Raw(kMagic, sizeof(kMagic));
+    w.Pod(kVersion);
+    w.Pod(kByteOrder);
+
+    w.Tag("SRCE");
+    w.String(source.path);
+    w.Pod(source.size);
+    w.Pod(source.mtime);
+
+    w.Tag("HEAD");
+    w.String(name);
+    w.Pod(num_client);
+    w.Pod(num_order);
+    w.Pod(num_vehicle);
+    w.Pod(num_region);
+    w.Pod(num_carrier);
+    w.Pod(num_billing);
+    w.Pod(plan_horizon.first);
+    w.Pod(plan_horizon.second);
+    w.Pod(depot_id);
+
+    w.Tag("SYMB");
+    WriteSymbols(w, region_symbols);
+    WriteSymbols(w, client_symbols);
+    WriteSymbols(w, order_symbols);
+    WriteSymbols(w, carrier_symbols);
+    WriteSymbols(w, vehicle_symbols);
+    WriteSymbols(w, billing_symbols);
+
+    // clients, orders and vehicles column by column
+    w.Tag("CLNT");
+    std::vector<int> region(num_client), ready(num_client);
+    std::vector<int> due(num_client), service(num_client);
+    for (int i = 0; i < num_client; ++i) {
+        region[i] = client_vec[i].get_region();
+        ready[i] = client_vec[i].get_ready_time() / 60;
+        due[i] = client_vec[i].get_due_time() / 60;
+        service[i] = client_vec[i].get_service_time() / 60;
+    }
+    w.Array(region);
+    w.Array(ready);
+    w.Array(due);
+    w.Array(service);
+
+    w.Tag("ORDR");
+    std::vector<int> client(num_order), quantity(num_order);
+    std::vector<int> ready_date(num_order), due_date(num_order);
+    std::vector<int> group(num_order);
+    std::vector<uint8_t> mandatory(num_order);
+    for (int i = 0; i < num_order; ++i) {
+        client[i] = order_vec[i].get_client();
+        quantity[i] = order_vec[i].get_demand();
+        mandatory[i] = order_vec[i].IsMandatory();
+        ready_date[i] = order_vec[i].get_dw().first;
+        due_date[i] = order_vec[i].get_dw().second;
+        group[i] = order_vec[i].get_group();
+    }
+    w.Array(client);
+    w.Array(quantity);
+    w.Array(mandatory);
+    w.Array(ready_date);
+    w.Array(due_date);
+    w.Array(group);
+
+    // order groups as member lists, in CSR form
+    w.Tag("GRUP");
+    std::vector<int> first(1, 0), members;
+    for (unsigned i = 0; i < ordergroup_vec.size(); ++i) {
+        for (unsigned k = 0; k < ordergroup_vec[i].size(); ++k)
+            members.push_back(ordergroup_vec[i][k]);
+        first.push_back(members.size());
+    }
+    w.Array(first);
+    w.Array(members);
+
+    w.Tag("VEHI");
+    std::vector<int> carrier(num_vehicle);
+    std::vector<unsigned> cap(num_vehicle), fixed_cost(num_vehicle);
+    for (int i = 0; i < num_vehicle; ++i) {
+        carrier[i] = vehicle_vec[i].get_carrier();
+        cap[i] = vehicle_vec[i].get_cap();
+        fixed_cost[i] = vehicle_vec[i].fixed_cost();
+    }
+    w.Array(carrier);
+    w.Array(cap);
+    w.Array(fixed_cost);
+
+    w.Tag("CARR");
+    std::vector<int> billing(num_carrier);
+    for (int i = 0; i < num_carrier; ++i)
+        billing[i] = carrier_vec[i].get_billing();
+    w.Array(billing);
+    w.Bits(site_map);
+
+    w.Tag("BILL");
+    for (int i = 0; i < num_billing; ++i) {
+        w.Pod(billing_vec[i]->get_type());
+        billing_vec[i]->Save(w);
+    }
+
+    w.Tag("MTRX");
+    arcs.Save(w);
+
+    // reachability bitsets, both directions
+    w.Tag("REAC");
+    w.Bits(group_vehicles);
+    w.Bits(vehicle_groups);
+    w.Tag("ROUT");
+    w.Bits(group_fits);
+    w.Table(date_penalty);
+    w.Tag("END.");
+}
+
+void ProbInput::ReadCompiled(const std::string &source) {
+    BinaryReader r(image->data(), image->data() + image->size(), source);
+    if (!IsCompiled(image->data(), image->size()))
+        r.Fail("not a compiled instance");
+    ReadCompiled(r);
+}
+
+void ProbInput::ReadCompiled(BinaryReader &r) {
+    r.View(sizeof(kMagic));
+    if (r.Pod<uint32_t>() != kVersion)
+        r.Fail("compiled with another version, recompile the instance");
+    if (r.Pod<uint32_t>() != kByteOrder)
+        r.Fail("compiled on a machine with another byte order");
+
+    r.Tag("SRCE");
+    source.path = r.String();
+    source.size = r.Pod<uint64_t>();
+    source.mtime = r.Pod<int64_t>();
+
+    r.Tag("HEAD");
+    name = r.String();
+    num_client = r.Pod<int>();
+    num_order = r.Pod<int>();
+    num_vehicle = r.Pod<int>();
+    num_region = r.Pod<int>();
+    num_carrier = r.Pod<int>();
+    num_billing = r.Pod<int>();
+    plan_horizon.first = r.Pod<int>();
+    plan_horizon.second = r.Pod<int>();
+    depot_id = r.Pod<int>();
+    if (num_client <= 0 || num_order <= 0 || num_vehicle <= 0 ||
+        num_region <= 0 || num_carrier <= 0 || num_billing <= 0 ||
+        depot_id < 0 || depot_id >= num_client)
+        r.Fail("bad header");
+
+    r.Tag("SYMB");
+    ReadSymbols(r, region_symbols, num_region);
+    ReadSymbols(r, client_symbols, num_client);
+    ReadSymbols(r, order_symbols, num_order);
+    ReadSymbols(r, carrier_symbols, num_carrier);
+    ReadSymbols(r, vehicle_symbols, num_vehicle);
+    ReadSymbols(r, billing_symbols, num_billing);
+
+    r.Tag("CLNT");
+    std::vector<int> region, ready, due, service;
+    r.Array(region);
+    r.Array(ready);
+    r.Array(due);
+    r.Array(service);
+    CheckSize(r, region, num_client);
+    CheckSize(r, ready, num_client);
+    CheckSize(r, due, num_client);
+    CheckSize(r, service, num_client);
+    CheckRange(r, region, num_region);
+    client_vec.reserve(num_client);
+    for (int i = 0; i < num_client; ++i)
+        client_vec.push_back(Client(i, region[i], ready[i], due[i],
+                                    service[i]));
+
+    r.Tag("ORDR");
+    std::vector<int> client, quantity, ready_date, due_date, group;
+    std::vector<uint8_t> mandatory;
+    r.Array(client);
+    r.Array(quantity);
+    r.Array(mandatory);
+    r.Array(ready_date);
+    r.Array(due_date);
+    r.Array(group);
+    CheckSize(r, client, num_order);
+    CheckSize(r, quantity, num_order);
+    CheckSize(r, mandatory, num_order);
+    CheckSize(r, ready_date, num_order);
+    CheckSize(r, due_date, num_order);
+    CheckSize(r, group, num_order);
+    CheckRange(r, client, num_client);
+    order_vec.reserve(num_order);
+    for (int i = 0; i < num_order; ++i) {
+        order_vec.push_back(Order(i, client[i], quantity[i], mandatory[i],
+                                  ready_date[i], due_date[i]));
+        order_vec[i].set_group(group[i]);
+    }
+
+    r.Tag("GRUP");
+    std::vector<int> first, members;
+    r.Array(first);
+    r.Array(members);
+    if (first.size() < 2 || first[0] != 0 ||
+        first.back() != static_cast<int>(members.size()))
+        r.Fail("bad order groups");
+    CheckRange(r, members, num_order);
+    ordergroup_vec.reserve(first.size() - 1);
+    for (unsigned i = 0; i + 1 < first.size(); ++i) {
+        if (first[i] >= first[i + 1])
+            r.Fail("empty order group");
+        OrderGroup og(order_vec[members[first[i]]]);
+        for (int k = first[i] + 1; k < first[i + 1]; ++k)
+            og.insert(order_vec[members[k]]);
+        ordergroup_vec.push_back(og);
+    }
+    CheckRange(r, group, ordergroup_vec.size());
+
+    r.Tag("VEHI");
+    std::vector<int> carrier;
+    std::vector<unsigned> cap, fixed_cost;
+    r.Array(carrier);
+    r.Array(cap);
+    r.Array(fixed_cost);
+    CheckSize(r, carrier, num_vehicle);
+    CheckSize(r, cap, num_vehicle);
+    CheckSize(r, fixed_cost, num_vehicle);
+    CheckRange(r, carrier, num_carrier);
+    vehicle_vec.reserve(num_vehicle);
+    for (int i = 0; i < num_vehicle; ++i)
+        vehicle_vec.push_back(Vehicle(i, carrier[i], cap[i], fixed_cost[i]));
+
+    r.Tag("CARR");
+    std::vector<int> billing;
+    r.Array(billing);
+    CheckSize(r, billing, num_carrier);
+    CheckRange(r, billing, num_billing);
+    for (int i = 0; i < num_carrier; ++i)
+        carrier_vec.push_back(Carrier(i, billing[i]));
+    r.Bits(site_map);
+    if (site_map.rows() != num_carrier || site_map.bits() != num_region)
+        r.Fail("carrier site map does not match the header");
+
+    r.Tag("BILL");
+    CreateCostComponents();
+    billing_vec.reserve(num_billing);
+    for (int i = 0; i < num_billing; ++i) {
+        Billing *b = NewBilling(i, r.Pod<int>());
+        if (!b)
+            r.Fail("unknown billing type");
+        billing_vec.push_back(b);
+        b->Load(r);
+    }
+
+    r.Tag("MTRX");
+    arcs.Load(r);
+    if (arcs.size() != num_client)
+        r.Fail("matrix size does not match the header");
+
+    r.Tag("REAC");
+    r.Bits(group_vehicles);
+    r.Bits(vehicle_groups);
+    if (group_vehicles.rows() != get_num_ogroup() ||
+        group_vehicles.bits() != num_vehicle ||
+        vehicle_groups.rows() != num_vehicle ||
+        vehicle_groups.bits() != get_num_ogroup())
+        r.Fail("reachability map does not match the header");
+    r.Tag("ROUT");
+    r.Bits(group_fits);
+    r.Table(date_penalty);
+    if (group_fits.rows() != get_num_ogroup() ||
+        group_fits.bits() != num_vehicle ||
+        date_penalty.rows() != get_num_ogroup() ||
+        date_penalty.cols() != get_dayspan() + 1)
+        r.Fail("route feasibility tables do not match the header");
+    r.Tag("END.");
+}
@@ -0,0 +1,121 @@
+// Arc weights: the explicit EDGE_WEIGHT_SECTION, full or sparse, and
+// arcs derived from client coordinates with the header's speed model.
+#include "data/prob_input.h"
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cmath>
+
+namespace {
+
+const double kEarthRadius = 6371.0;  // km
+const double kPi = 3.14159265358979323846;
+
+double Haversine(double lat1, double lon1, double lat2, double lon2) {
+    double to_rad = kPi / 180;
+    double dlat = (lat2 - lat1) * to_rad;
+    double dlon = (lon2 - lon1) * to_rad;
+    double a = sin(dlat / 2) * sin(dlat / 2) +
+               cos(lat1 * to_rad) * cos(lat2 * to_rad) *
+               sin(dlon / 2) * sin(dlon / 2);
+    return 2 * kEarthRadius * asin(std::min(1.0, sqrt(a)));
+}
+
+// row(i) for every row, split among the hardware threads; interleaved
+// rows balance triangular work
+template <class Row>
+void ForEachRow(int num_rows, Row row) {
+    int num_threads = std::max(1u, std::thread::hardware_concurrency());
+    num_threads = std::min(num_threads, std::max(1, num_rows / 64));
+    std::vector<std::thread> threads;
+    for (int k = 0; k < num_threads; ++k) {
+        threads.push_back(std::thread([&, k]() {
+            for (int i = k; i < num_rows; i += num_threads)
+                row(i);
+        }));
+    }
+    for (unsigned k = 0; k < threads.size(); ++k)
+        threads[k].join();
+}
+
+}  // namespace
+
+void ProbInput::ReadEdges(TextScanner &sc) {
+    const EdgeWeights &ew = edge_weights;
+    std::string id1, id2;
+    FlatTable<int> distance, time_dist;
+    distance.Assign(num_client, num_client, -1);
+    time_dist.Assign(num_client, num_client, -1);
+    if (ew.type != "EXPLICIT") {
+        sc.Expect("NODE_COORD_SECTION");
+        sc.SkipLine();
+        std::vector<double> x(num_client), y(num_client);
+        std::vector<bool> seen(num_client, false);
+        for (int i = 0; i < num_client; ++i) {
+            sc.Token(id1);
+            int c = IndexClient(id1);
+            if (c < 0)
+                sc.Fail("coordinates of unknown client " + id1);
+            if (seen[c])
+                sc.Fail("duplicate coordinates of client " + id1);
+            seen[c] = true;
+            x[c] = sc.Decimal("coordinate");
+            y[c] = sc.Decimal("coordinate");
+            sc.SkipLine();
+        }
+        ComputeEdges(x, y, distance, time_dist);
+    } else if (ew.format == "EDGE_LIST") {
+        int km = static_cast<int>(ew.default_km + 0.5);
+        int sec = ew.default_sec;
+        ForEachRow(num_client, [&](int i) {
+            for (int j = 0; j < num_client; ++j) {
+                distance.at(i, j) = i == j ? 0 : km;
+                time_dist.at(i, j) = i == j ? 0 : sec;
+            }
+        });
+    }
+
+    // explicit arcs, optional when there are coordinates
+    if (ew.type != "EXPLICIT" && !sc.TokenIs("EDGE_WEIGHT_SECTION")) {
+        arcs.Build(distance, time_dist);
+        return;
+    }
+    sc.Expect("EDGE_WEIGHT_SECTION");
+    sc.SkipLine();
+    while (!sc.AtEnd() && !sc.TokenIs("END")) {
+        sc.Token(id1);
+        sc.Token(id2);
+        double dist_km = sc.Decimal("edge distance");
+        int dist_sec = sc.Int("edge time");
+        int ind1 = IndexClient(id1);
+        int ind2 = IndexClient(id2);
+        if (ind1 < 0 || ind2 < 0)
+            sc.Fail("edge " + id1 + " " + id2 + ": unknown client");
+        distance.at(ind1, ind2) = static_cast<unsigned>(dist_km + 0.5);
+        time_dist.at(ind1, ind2) = dist_sec;
+        sc.SkipLine();
+    }
+    arcs.Build(distance, time_dist);
+}
+
+// Rows are split among the hardware threads; each arc is computed once
+// and mirrored.
+void ProbInput::ComputeEdges(const std::vector<double> &x,
+                             const std::vector<double> &y,
+                             FlatTable<int> &distance,
+                             FlatTable<int> &time_dist) const {
+    const EdgeWeights &ew = edge_weights;
+    bool geo = ew.type == "GEO";
+    ForEachRow(num_client, [&](int i) {
+        for (int j = 0; j <= i; ++j) {
+            double km = geo ? Haversine(x[i], y[i], x[j], y[j])
+                            : hypot(x[i] - x[j], y[i] - y[j]);
+            km *= ew.road_factor;
+            int d = static_cast<int>(km + 0.5);
+            int t = static_cast<int>(km / ew.speed * 3600 + 0.5);
+            distance.at(i, j) = distance.at(j, i) = d;
+            time_dist.at(i, j) = time_dist.at(j, i) = t;
+        }
+    });
+}
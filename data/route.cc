@@ -58,13 +58,14 @@ std::ostream& operator<<(std::ostream &os, const RoutePlan &rp) {
             os << "Day " << day + 1 <<" :" << std::endl;
         }
         const Vehicle& v = rp.in.VehicleVect(rp[i].get_vehicle());
-        os << "\t# " << i << "  " << v.get_id() << "(" << v.get_cap() << ") "
+        os << "\t# " << i << "  " << rp.in.VehicleName(v.get_id())
+           << "(" << v.get_cap() << ") "
            << rp[i].get_num_order() << ":";
 
         for (unsigned j = 0; j < rp[i].size(); ++j) {
             const OrderGroup &og = rp.in.OrderGroupVect(rp[i][j]);
             for (unsigned k = 0; k < og.size(); ++k)
-                os << " " << og[k];
+                os << " " << rp.in.OrderName(og[k]);
         }
         os << " [" << rp[i].demand() << "]" << std::endl;
     }
@@ -76,7 +77,7 @@ std::ostream& operator<<(std::ostream &os, const RoutePlan &rp) {
     for (unsigned i = 0; i < rp[uns].size(); ++i) {
         const OrderGroup &og = rp.in.OrderGroupVect(rp[uns][i]);
         for (unsigned k = 0; k < og.size(); ++k)
-            os << " " << og[k];
+            os << " " << rp.in.OrderName(og[k]);
     }
     os << " [" << rp[uns].demand() << "]" << std::endl;
     return os;
@@ -99,6 +100,37 @@ void RoutePlan::Allocate() {
     // plan.resize(num_vehicle, std::vector<int>(day_span, -1));
 }
 
+void Route::erase(unsigned pos) {
+    // the groups after pos move up one position
+    for (unsigned k = pos; k < orders.size(); ++k)
+        hash_ ^= Key(orders[k], id, k);
+    orders.erase(orders.begin() + pos);
+    for (unsigned k = pos; k < orders.size(); ++k)
+        hash_ ^= Key(orders[k], id, k);
+}
+
+void Route::insert(unsigned pos, int order) {
+    for (unsigned k = pos; k < orders.size(); ++k)
+        hash_ ^= Key(orders[k], id, k);
+    orders.insert(orders.begin() + pos, order);
+    for (unsigned k = pos; k < orders.size(); ++k)
+        hash_ ^= Key(orders[k], id, k);
+}
+
+uint64_t RoutePlan::hash() const {
+    uint64_t h = 0;
+    for (unsigned r = 0; r < routes_.size(); ++r)
+        h ^= routes_[r].hash();
+    return h;
+}
+
+void RoutePlan::RouteOf(std::vector<int> &route_of) const {
+    route_of.assign(in.get_num_ogroup(), routes_.size() - 1);
+    for (unsigned r = 0; r < routes_.size(); ++r)
+        for (unsigned k = 0; k < routes_[r].size(); ++k)
+            route_of[routes_[r][k]] = r;
+}
+
 unsigned Route::get_num_order() const {
     unsigned sz = 0;
     for (unsigned i = 0; i < orders.size(); ++i) {
@@ -110,10 +142,10 @@ unsigned Route::get_num_order() const {
 
 int Route::length() const {
     int len = 0;
-    std::string client_from(in.get_depot());
+    int client_from = in.get_depot();
     for (unsigned i = 0; i < orders.size(); ++i) {
         const OrderGroup &og = in.OrderGroupVect(orders[i]);
-        std::string client_to = og.get_client();
+        int client_to = og.get_client();
         len += in.get_distance(client_from, client_to);
         client_from = client_to;
     }
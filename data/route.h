@@ -1,5 +1,6 @@
 #ifndef _ROUTE_H_
 #define _ROUTE_H_
+#include <stdint.h>
 #include <iostream>
 #include <vector>
 #include "data/prob_input.h"
@@ -7,38 +8,65 @@
 class Route {
  public:
     Route(int i, bool e, const ProbInput &p):
-        id(i), exc_list(e), orders(0), in(p) { }
+        id(i), exc_list(e), orders(0), in(p), hash_(0) { }
     // Route(std::vector<int> ov):
     //     day(0), vehicle(0), exc_list(true), orders(ov) { }
     Route(const Route &r):
-        id(r.id), exc_list(r.exc_list), orders(r.orders), in(r.in) { }
+        id(r.id), exc_list(r.exc_list), orders(r.orders), in(r.in),
+        hash_(r.hash_) { }
     unsigned size() const { return orders.size(); }
     int length() const;
     int demand() const;
+    int get_id() const { return id; }
     int get_day() const { return id / in.get_num_vehicle(); }
     int get_vehicle() const { return id % in.get_num_vehicle(); }
     bool IsExcList() const { return exc_list; }
     void set_ext_list(bool unschduled) { exc_list = unschduled; }
     unsigned get_num_order() const;
-    void push_back(int order_index) { orders.push_back(order_index); }
-    void erase(unsigned pos) { orders.erase(orders.begin() + pos); }
-    void insert(unsigned pos, int order) {
-        orders.insert(orders.begin() + pos, order);
+    void push_back(int order_index) {
+        hash_ ^= Key(order_index, id, orders.size());
+        orders.push_back(order_index);
     }
-    void clear() { orders.clear(); }
+    void erase(unsigned pos);
+    void insert(unsigned pos, int order);
+    void set(unsigned pos, int order) {
+        hash_ ^= Key(orders[pos], id, pos) ^ Key(order, id, pos);
+        orders[pos] = order;
+    }
+    // exchanges the group at pos with the one at r_pos of r, maybe *this
+    void SwapOrder(unsigned pos, Route &r, unsigned r_pos) {
+        int order = orders[pos];
+        set(pos, r.orders[r_pos]);
+        r.set(r_pos, order);
+    }
+    void clear() { orders.clear(); hash_ = 0; }
     const int& operator[] (int i) const { return orders[i]; }
-    int& operator[] (int i) { return orders[i]; }
     Route& operator=(const Route &r) {
         id = r.id;
         orders = r.orders;
+        hash_ = r.hash_;
         return *this;
     }
+    // Zobrist hash of the stops over (order group, route, position),
+    // kept up to date by every change above
+    uint64_t hash() const { return hash_; }
 
  private:
     int id;
     bool exc_list;
+    // fixed pseudo-random key of a group at a position of a route: the
+    // splitmix64 finaliser of the three packed together
+    static uint64_t Key(int order, int route, unsigned pos) {
+        uint64_t x = (static_cast<uint64_t>(order) << 40) ^
+            (static_cast<uint64_t>(route) << 20) ^ pos;
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
     std::vector<int> orders;
     const ProbInput &in;
+    uint64_t hash_;
 };
 
 class RoutePlan {
@@ -75,6 +103,10 @@ class RoutePlan {
     }
     // check whether a route plan is feasible
     bool CheckFeasibility();
+    // Zobrist hash of the whole plan, from the hashes of its routes
+    uint64_t hash() const;
+    // the route of each order group, the unscheduled list's if in none
+    void RouteOf(std::vector<int> &route_of) const;
     void set_vio(int v) const { vios = v; }
     int get_vio() const { return vios; }
 
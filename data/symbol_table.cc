@@ -0,0 +1,19 @@
+#include "data/symbol_table.h"
+#include <string>
+
+int SymbolTable::Intern(const std::string &s) {
+    std::unordered_map<std::string, int>::const_iterator it = index.find(s);
+    if (it != index.end())
+        return it->second;
+    int h = names.size();
+    index[s] = h;
+    names.push_back(s);
+    return h;
+}
+
+int SymbolTable::Find(const std::string &s) const {
+    std::unordered_map<std::string, int>::const_iterator it = index.find(s);
+    if (it != index.end())
+        return it->second;
+    return -1;  // not found
+}
@@ -0,0 +1,21 @@
+#ifndef _SYMBOL_TABLE_H_
+#define _SYMBOL_TABLE_H_
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// Interns the string ids of the input file into dense integer handles.
+// Handles are given in order of first appearance, so for each kind of
+// object the handle is also its index in the ProbInput vectors. The
+// strings are only needed again when a plan is printed.
+class SymbolTable {
+ public:
+    int Intern(const std::string&);
+    int Find(const std::string&) const;
+    const std::string& Name(int h) const { return names[h]; }
+    int size() const { return names.size(); }
+ private:
+    std::unordered_map<std::string, int> index;
+    std::vector<std::string> names;
+};
+#endif
@@ -0,0 +1,217 @@
+#include "data/text_scanner.h"
+#include <string>
+#include <sstream>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+inline bool IsBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v'
+           || c == '\f';
+}
+
+inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+const double kPow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+}  // namespace
+
+long ParseInt(const char *b, const char *e, const char **stop) {
+    const char *p = b;
+    bool neg = false;
+    if (p < e && (*p == '-' || *p == '+'))
+        neg = (*p++ == '-');
+    if (p == e || !IsDigit(*p)) {
+        *stop = b;
+        return 0;
+    }
+    long v = 0;
+    while (p < e && IsDigit(*p)) {
+        if (v > (2147483647L - (*p - '0')) / 10) {  // keep it in an int
+            *stop = b;
+            return 0;
+        }
+        v = v * 10 + (*p++ - '0');
+    }
+    *stop = p;
+    return neg ? -v : v;
+}
+
+// Decimals with at most 15 significant digits and 22 decimals are
+// computed as mantissa / 10^k, a single correctly rounded division, so
+// the result is bit-identical to strtod. Anything longer (or with an
+// exponent) falls back to strtod.
+double ParseDecimal(const char *b, const char *e, const char **stop) {
+    const char *p = b;
+    bool neg = false;
+    if (p < e && (*p == '-' || *p == '+'))
+        neg = (*p++ == '-');
+    long long mantissa = 0;
+    int digits = 0, decimals = 0;
+    bool any = false;
+    while (p < e && IsDigit(*p)) {
+        if (mantissa || *p != '0')
+            ++digits;
+        mantissa = mantissa * 10 + (*p++ - '0');
+        any = true;
+        if (digits > 15) break;
+    }
+    if (digits <= 15 && p < e && *p == '.') {
+        ++p;
+        while (p < e && IsDigit(*p)) {
+            if (mantissa || *p != '0')
+                ++digits;
+            mantissa = mantissa * 10 + (*p++ - '0');
+            ++decimals;
+            any = true;
+            if (digits > 15) break;
+        }
+    }
+    bool slow = digits > 15 || decimals > 22 ||
+                (p < e && (*p == 'e' || *p == 'E' || IsDigit(*p)));
+    if (!any && !slow) {
+        *stop = b;
+        return 0.0;
+    }
+    if (slow) {
+        char buf[64];
+        const char *q = b;
+        while (q < e && !IsBlank(*q) && *q != ';') ++q;
+        size_t len = q - b;
+        if (len >= sizeof(buf)) {
+            *stop = b;
+            return 0.0;
+        }
+        memcpy(buf, b, len);
+        buf[len] = '\0';
+        char *end;
+        double v = strtod(buf, &end);
+        *stop = b + (end - buf);
+        return v;
+    }
+    *stop = p;
+    double v = static_cast<double>(mantissa) / kPow10[decimals];
+    return neg ? -v : v;
+}
+
+void TextScanner::SkipBlanks() {
+    while (cur_ < end_ && IsBlank(*cur_))
+        ++cur_;
+}
+
+bool TextScanner::AtEnd() {
+    SkipBlanks();
+    return cur_ == end_;
+}
+
+bool TextScanner::AtEndOfLine() {
+    while (cur_ < end_ && IsBlank(*cur_) && *cur_ != '\n')
+        ++cur_;
+    return cur_ == end_ || *cur_ == '\n';
+}
+
+void TextScanner::Token(const char **b, size_t *len) {
+    SkipBlanks();
+    const char *p = cur_;
+    while (cur_ < end_ && !IsBlank(*cur_))
+        ++cur_;
+    *b = p;
+    *len = cur_ - p;
+}
+
+std::string TextScanner::Token() {
+    std::string s;
+    Token(s);
+    return s;
+}
+
+void TextScanner::Token(std::string &s) {
+    const char *b;
+    size_t len;
+    Token(&b, &len);
+    s.assign(b, len);
+}
+
+bool TextScanner::TokenIs(const char *word) {
+    SkipBlanks();
+    size_t len = strlen(word);
+    if (static_cast<size_t>(end_ - cur_) < len || memcmp(cur_, word, len))
+        return false;
+    return cur_ + len == end_ || IsBlank(cur_[len]);
+}
+
+long TextScanner::Int(const char *what) {
+    SkipBlanks();
+    const char *stop;
+    long v = ParseInt(cur_, end_, &stop);
+    if (stop == cur_ || (stop < end_ && !IsBlank(*stop) && *stop != ';'))
+        Fail(std::string("expected an integer for ") + what);
+    cur_ = stop;
+    return v;
+}
+
+double TextScanner::Decimal(const char *what) {
+    SkipBlanks();
+    const char *stop;
+    double v = ParseDecimal(cur_, end_, &stop);
+    if (stop == cur_ || (stop < end_ && !IsBlank(*stop) && *stop != ';'))
+        Fail(std::string("expected a number for ") + what);
+    cur_ = stop;
+    return v;
+}
+
+void TextScanner::SkipLine() {
+    const char *nl = static_cast<const char*>(memchr(cur_, '\n',
+                                                     end_ - cur_));
+    cur_ = nl ? nl + 1 : end_;
+}
+
+std::string TextScanner::RestOfLine() {
+    const char *nl = static_cast<const char*>(memchr(cur_, '\n',
+                                                     end_ - cur_));
+    const char *e = nl ? nl : end_;
+    const char *b = cur_;
+    cur_ = nl ? nl + 1 : end_;
+    while (b < e && IsBlank(*b)) ++b;
+    while (e > b && IsBlank(e[-1])) --e;
+    return std::string(b, e);
+}
+
+void TextScanner::Until(char delim, const char **b, const char **e) {
+    const char *d = static_cast<const char*>(memchr(cur_, delim,
+                                                    end_ - cur_));
+    if (!d)
+        Fail(std::string("missing '") + delim + "'");
+    *b = cur_;
+    *e = d;
+    cur_ = d + 1;
+}
+
+void TextScanner::Expect(const char *word) {
+    if (!TokenIs(word)) {
+        SkipBlanks();
+        const char *p = cur_;
+        while (p < end_ && !IsBlank(*p)) ++p;
+        Fail(std::string("expected ") + word + ", found '"
+             + std::string(cur_, p) + "'");
+    }
+    cur_ += strlen(word);
+}
+
+int TextScanner::LineNumber() const {
+    int line = 1;
+    for (const char *p = begin_; p < cur_ && p < end_; ++p)
+        if (*p == '\n') ++line;
+    return line;
+}
+
+void TextScanner::Fail(const std::string &msg) const {
+    std::ostringstream os;
+    os << source_ << ":" << LineNumber() << ": " << msg;
+    throw std::runtime_error(os.str());
+}
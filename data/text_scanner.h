@@ -0,0 +1,41 @@
+#ifndef _TEXT_SCANNER_H_
+#define _TEXT_SCANNER_H_
+#include <string>
+#include <cstddef>
+
+// Scanner over a .vrp text held in memory (usually a MappedFile).
+// Tokens are whitespace delimited; numbers are parsed in place without
+// going through iostreams. Malformed input is reported by throwing
+// std::runtime_error with the source name and the line number.
+class TextScanner {
+ public:
+    TextScanner(const char *begin, const char *end, const std::string &src):
+        begin_(begin), cur_(begin), end_(end), source_(src) { }
+    bool AtEnd();
+    bool AtEndOfLine();
+    // next token, the view stays valid as long as the buffer
+    void Token(const char **b, size_t *len);
+    std::string Token();
+    void Token(std::string &s);
+    bool TokenIs(const char *word);
+    long Int(const char *what);
+    double Decimal(const char *what);
+    // consume the rest of the current line, including the newline
+    void SkipLine();
+    // the rest of the current line, without the trailing blanks
+    std::string RestOfLine();
+    // consume everything up to and including the next delimiter
+    void Until(char delim, const char **b, const char **e);
+    void Expect(const char *word);
+    void Fail(const std::string &msg) const;
+ private:
+    void SkipBlanks();
+    int LineNumber() const;
+    const char *begin_, *cur_, *end_;
+    std::string source_;
+};
+
+long ParseInt(const char *b, const char *e, const char **stop);
+double ParseDecimal(const char *b, const char *e, const char **stop);
+
+#endif
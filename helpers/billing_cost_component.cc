@@ -1,10 +1,28 @@
 #include "helpers/billing_cost_component.h"
+#include <algorithm>
 #include <cmath>
 #include <utility>
 #include "data/route.h"
 #include "data/billing.h"
 #include "data/prob_input.h"
 
+RouteProfile::RouteProfile(const ProbInput &in, const Route &r):
+    length(r.length()), load(0) {
+    for (unsigned i = 0; i < r.size(); ++i) {
+        const OrderGroup &og = in.OrderGroupVect(r[i]);
+        Add(in.FindClient(og.get_client()).get_region(), og.get_demand());
+    }
+}
+
+void RouteProfile::Add(int region, int demand) {
+    unsigned k = 0;
+    while (k < regions.size() && regions[k].first != region)
+        ++k;
+    if (k == regions.size())
+        regions.push_back(std::make_pair(region, 0));
+    regions[k].second += demand;
+    load += demand;
+}
 
 // rate/load type is set to int
 // bt1
@@ -14,6 +32,17 @@ int DistanceBillingCostComponent::ComputeCost(const Route &r) const {
     return (r.length() * cr->get_km_rate());
 }
 
+int DistanceBillingCostComponent::ComputeCost(const RouteProfile &p,
+                                              int vehicle) const {
+    const KmBilling* cr = static_cast<const KmBilling*>(in.FindBilling(vehicle));
+    return (p.length * cr->get_km_rate());
+}
+
+int DistanceBillingCostComponent::KmRate(const Route &r) const {
+    int vehicle = r.get_vehicle();
+    return static_cast<const KmBilling*>(in.FindBilling(vehicle))->get_km_rate();
+}
+
 // bt2
 int DistanceLoadBillingCostComponent::ComputeCost(const Route &r) const {
     int cost = 0;
@@ -31,6 +60,28 @@ int DistanceLoadBillingCostComponent::ComputeCost(const Route &r) const {
     return cost;
 }
 
+int DistanceLoadBillingCostComponent::ComputeCost(const RouteProfile &p,
+                                                  int vehicle) const {
+    const LoadKmBilling* cr =
+            static_cast<const LoadKmBilling*>(in.FindBilling(vehicle));
+    double full = cr->get_full_load() / 100.0;
+    if (p.load >= full * in.VehicleVect(vehicle).get_cap()) {
+        int max_rate = 0;
+        for (unsigned k = 0; k < p.regions.size(); ++k)
+            max_rate = std::max(max_rate, cr->get_load_cost(p.regions[k].first));
+        return p.load * max_rate;
+    }
+    return p.length * cr->get_km_rate();
+}
+
+int DistanceLoadBillingCostComponent::KmRate(const Route &r) const {
+    if (IsFull(r))
+        return 0;
+    const LoadKmBilling* cr =
+            static_cast<const LoadKmBilling*>(in.FindBilling(r.get_vehicle()));
+    return cr->get_km_rate();
+}
+
 std::pair<int, int>
 DistanceLoadBillingCostComponent::MaxRateLoad(const Route &r) const {
     int vehicle = r.get_vehicle();
@@ -38,8 +89,8 @@ DistanceLoadBillingCostComponent::MaxRateLoad(const Route &r) const {
     const LoadKmBilling *cr =
             static_cast<const LoadKmBilling*>(in.FindBilling(vehicle));
     for (unsigned i = 0; i < r.size(); ++i) {
-        std::string client_id = in.OrderGroupVect(r[i]).get_client();
-        int rindex = in.IndexRegion(in.FindClient(client_id).get_region());
+        int client_id = in.OrderGroupVect(r[i]).get_client();
+        int rindex = in.FindClient(client_id).get_region();
         if (cr->get_load_cost(rindex) > max_rate)
             max_rate = cr->get_load_cost(rindex);
         load += in.OrderGroupVect(r[i]).get_demand();
@@ -87,9 +138,31 @@ int LoadRangeBillingCostComponent::ComputeCost(const Route &r) const {
     return cost;
 }
 
+int LoadRangeBillingCostComponent::ComputeCost(const RouteProfile &p,
+                                               int vehicle) const {
+    const VarLoadBilling *cr =
+            static_cast<const VarLoadBilling*>(in.FindBilling(vehicle));
+    unsigned range = FindRange(vehicle, p.load);
+    int max_rate = MaxRate(p, vehicle, range);
+    if (range > 0) {
+        // as for a route, see above
+        int threshold_cost = MaxRate(p, vehicle, range - 1) *
+            cr->get_level(range - 1);
+        int threshold_qty = static_cast<int>(floor(
+                            static_cast<double>(threshold_cost)/max_rate));
+        if (p.load <= threshold_qty)
+            return threshold_cost;
+    }
+    return p.load * max_rate;
+}
+
 unsigned
 LoadRangeBillingCostComponent::FindRange(const Route &r, int load) const {
-    int vehicle = r.get_vehicle();
+    return FindRange(r.get_vehicle(), load);
+}
+
+unsigned
+LoadRangeBillingCostComponent::FindRange(int vehicle, int load) const {
     const VarLoadBilling *cr =
         static_cast<const VarLoadBilling*>(in.FindBilling(vehicle));
 
@@ -111,14 +184,26 @@ LoadRangeBillingCostComponent::MaxRate(const Route &r, unsigned range) const {
 
     int max_rate = 0;
     for (unsigned i = 0; i < r.size(); ++i) {
-        std::string client_id = in.OrderGroupVect(r[i]).get_client();
-        int rindex = in.IndexRegion(in.FindClient(client_id).get_region());
+        int client_id = in.OrderGroupVect(r[i]).get_client();
+        int rindex = in.FindClient(client_id).get_region();
         if (max_rate < cr->get_load_cost(rindex, range))
             max_rate = cr->get_load_cost(rindex, range);
     }
     return max_rate;
 }
 
+int LoadRangeBillingCostComponent::MaxRate(const RouteProfile &p,
+                                           int vehicle,
+                                           unsigned range) const {
+    const VarLoadBilling *cr =
+            static_cast<const VarLoadBilling*>(in.FindBilling(vehicle));
+    int max_rate = 0;
+    for (unsigned k = 0; k < p.regions.size(); ++k)
+        max_rate = std::max(max_rate,
+                            cr->get_load_cost(p.regions[k].first, range));
+    return max_rate;
+}
+
 // bt4
 int LoadFarestClientCostComponent::ComputeCost(const Route &r) const {
     // int vehicle = r.get_vehicle();
@@ -127,6 +212,16 @@ int LoadFarestClientCostComponent::ComputeCost(const Route &r) const {
     return (load * max_rate);
 }
 
+int LoadFarestClientCostComponent::ComputeCost(const RouteProfile &p,
+                                               int vehicle) const {
+    const LoadBilling *cr =
+            static_cast<const LoadBilling*>(in.FindBilling(vehicle));
+    int max_rate = 0;
+    for (unsigned k = 0; k < p.regions.size(); ++k)
+        max_rate = std::max(max_rate, cr->get_load_cost(p.regions[k].first));
+    return p.load * max_rate;
+}
+
 std::pair<int, int>
 LoadFarestClientCostComponent::MaxRateLoad(const Route &r) const {
     int vehicle = r.get_vehicle();
@@ -134,8 +229,8 @@ LoadFarestClientCostComponent::MaxRateLoad(const Route &r) const {
     const LoadBilling *cr =
             static_cast<const LoadBilling*>(in.FindBilling(vehicle));
     for (unsigned i = 0; i < r.size(); ++i) {
-        std::string client_id = in.OrderGroupVect(r[i]).get_client();
-        int rindex = in.IndexRegion(in.FindClient(client_id).get_region());
+        int client_id = in.OrderGroupVect(r[i]).get_client();
+        int rindex = in.FindClient(client_id).get_region();
         if (cr->get_load_cost(rindex) > max_rate)
             max_rate = cr->get_load_cost(rindex);
         load += in.OrderGroupVect(r[i]).get_demand();
@@ -150,11 +245,21 @@ int LoadClientDependentCostComponent::ComputeCost(const Route &r) const {
             static_cast<const LoadBilling*>(in.FindBilling(vehicle));
 
     for (unsigned i = 0; i < r.size(); ++i) {
-        std::string client_id = in.OrderGroupVect(r[i]).get_client();
-        int rindex = in.IndexRegion(in.FindClient(client_id).get_region());
+        int client_id = in.OrderGroupVect(r[i]).get_client();
+        int rindex = in.FindClient(client_id).get_region();
         int rate = cr->get_load_cost(rindex);
         cost += in.OrderGroupVect(r[i]).get_demand() * rate;
     }
 
     return cost;
 }
+
+int LoadClientDependentCostComponent::ComputeCost(const RouteProfile &p,
+                                                  int vehicle) const {
+    const LoadBilling *cr =
+            static_cast<const LoadBilling*>(in.FindBilling(vehicle));
+    int cost = 0;
+    for (unsigned k = 0; k < p.regions.size(); ++k)
+        cost += p.regions[k].second * cr->get_load_cost(p.regions[k].first);
+    return cost;
+}
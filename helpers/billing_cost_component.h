@@ -3,19 +3,46 @@
 #include <iostream>
 #include <string>
 #include <utility>
+#include <vector>
 
 class Route;
 class ProbInput;
 
+// All a bill reads of a route besides its vehicle, so that the route can
+// be billed in another vehicle without a pass over its stops.
+struct RouteProfile {
+    RouteProfile(): length(0), load(0) { }
+    RouteProfile(const ProbInput &in, const Route &r);
+    // one more stop, delivering demand in region
+    void Add(int region, int demand);
+    int length;
+    int load;
+    // demand delivered in each region visited, one entry per region
+    std::vector<std::pair<int, int> > regions;
+};
+
 class BillingCostComponent {
  public:
     BillingCostComponent(const ProbInput &i, int w, std::string n):
         in(i), weight(w), name(n) { }
     virtual ~BillingCostComponent() { }
     virtual int ComputeCost(const Route &r) const = 0;
+    // the same for a route with profile p in vehicle
+    virtual int ComputeCost(const RouteProfile &p, int vehicle) const = 0;
     int Cost(const Route &r) const {
         return weight * ComputeCost(r);
     }
+    int Cost(const RouteProfile &p, int vehicle) const {
+        return weight * ComputeCost(p, vehicle);
+    }
+    // what one more unit of length costs with the load of r, 0 where the
+    // bill does not depend on the length
+    virtual int KmRate(const Route&) const { return 0; }
+    // true if the bill is LengthCost of the route length alone
+    virtual bool ByLength() const { return false; }
+    int LengthCost(const Route &r, int length) const {
+        return weight * KmRate(r) * length;
+    }
     std::string Name() const { return name; }
     // virtual void PrintViolations(const Route &r, unsigned route_index,
     //                              std::ostream &os = std::cout);
@@ -34,6 +61,9 @@ class DistanceBillingCostComponent: public BillingCostComponent {
         BillingCostComponent(in, weight, "DistanceBillingCostComponent") {}
     virtual ~DistanceBillingCostComponent() { }
     int ComputeCost(const Route &r) const;
+    int ComputeCost(const RouteProfile &p, int vehicle) const;
+    int KmRate(const Route &r) const;
+    bool ByLength() const { return true; }
 };
 
 
@@ -43,6 +73,7 @@ class LoadFarestClientCostComponent: public BillingCostComponent {
         BillingCostComponent(in, weight, "LoadFarestClientCostComponent") {}
     virtual ~LoadFarestClientCostComponent() { }
     int  ComputeCost(const Route &r) const;
+    int ComputeCost(const RouteProfile &p, int vehicle) const;
  private:
     std::pair<int, int> MaxRateLoad(const Route &r) const;
 };
@@ -55,9 +86,12 @@ class LoadRangeBillingCostComponent: public BillingCostComponent {
         BillingCostComponent(in, weight, "LoadRangeBillingCostComponent") {}
     virtual ~LoadRangeBillingCostComponent() { }
     int  ComputeCost(const Route &r) const;
+    int ComputeCost(const RouteProfile &p, int vehicle) const;
  private:
     unsigned FindRange(const Route &r, int load) const;
+    unsigned FindRange(int vehicle, int load) const;
     int MaxRate(const Route &r, unsigned range) const;
+    int MaxRate(const RouteProfile &p, int vehicle, unsigned range) const;
 };
 
 // DistanceLoadBillingCostComponent
@@ -69,6 +103,8 @@ class DistanceLoadBillingCostComponent: public BillingCostComponent {
     // pair<unsigned, unsigned> MaxRateLoad(const Route &r) const;
     virtual ~DistanceLoadBillingCostComponent() { }
     int ComputeCost(const Route &r) const;
+    int ComputeCost(const RouteProfile &p, int vehicle) const;
+    int KmRate(const Route &r) const;
  private:
     std::pair<int, int> MaxRateLoad(const Route &r) const;
     bool IsFull(const Route &r) const;
@@ -83,6 +119,7 @@ class LoadClientDependentCostComponent: public BillingCostComponent {
         BillingCostComponent(in, weight, "LoadClientDependentCostComponent") {}
     virtual ~LoadClientDependentCostComponent() { }
     int  ComputeCost(const Route &r) const;
+    int ComputeCost(const RouteProfile &p, int vehicle) const;
 };
 
 #endif
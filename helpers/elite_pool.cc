@@ -0,0 +1,59 @@
+#include "helpers/elite_pool.h"
+#include "helpers/vrp_random.h"
+#include <climits>
+#include <vector>
+
+unsigned ElitePool::Distance(const std::vector<int> &a,
+                             const std::vector<int> &b) {
+    unsigned d = 0;
+    for (unsigned g = 0; g < a.size(); ++g)
+        d += a[g] != b[g];
+    return d;
+}
+
+bool ElitePool::Insert(const RoutePlan &rp, int cost) {
+    if (!capacity_)
+        return false;
+    std::vector<int> route_of;
+    rp.RouteOf(route_of);
+    int nearest = -1, worst = -1;
+    unsigned nearest_distance = UINT_MAX;
+    for (unsigned i = 0; i < elites_.size(); ++i) {
+        unsigned d = Distance(route_of, elites_[i].route_of);
+        if (d < nearest_distance) {
+            nearest = i;
+            nearest_distance = d;
+        }
+        if (worst < 0 || elites_[i].cost > elites_[worst].cost)
+            worst = i;
+    }
+    int slot;
+    if (nearest >= 0 && nearest_distance < min_distance_) {
+        if (cost >= elites_[nearest].cost)
+            return false;
+        slot = nearest;
+    } else if (elites_.size() < capacity_) {
+        slot = elites_.size();
+        elites_.push_back(Elite(rp, cost));
+    } else if (cost < elites_[worst].cost) {
+        slot = worst;
+    } else {
+        return false;
+    }
+    elites_[slot].plan = rp;
+    elites_[slot].cost = cost;
+    elites_[slot].route_of.swap(route_of);
+    return true;
+}
+
+int ElitePool::PickGuide(const RoutePlan &rp) const {
+    std::vector<int> route_of;
+    rp.RouteOf(route_of);
+    std::vector<int> others;
+    for (unsigned i = 0; i < elites_.size(); ++i)
+        if (Distance(route_of, elites_[i].route_of))
+            others.push_back(i);
+    if (others.empty())
+        return -1;
+    return others[VRPRandom::Int(0, others.size() - 1)];
+}
@@ -0,0 +1,42 @@
+#ifndef _ELITE_POOL_H_
+#define _ELITE_POOL_H_
+#include <vector>
+#include "data/route.h"
+#include "data/prob_input.h"
+
+// The best plans found so far that differ enough from each other. Two
+// plans are as far apart as the order groups they put in different
+// routes, the unscheduled list counting as a route. A plan closer than
+// min_distance to a member only replaces that member, and only if it
+// costs less; otherwise, with the pool full, it replaces the costliest
+// member if it costs less than that one.
+class ElitePool {
+ public:
+    ElitePool(unsigned capacity, unsigned min_distance):
+        capacity_(capacity),
+        min_distance_(min_distance ? min_distance : 1) { }
+    // true if rp got in
+    bool Insert(const RoutePlan &rp, int cost);
+    unsigned size() const { return elites_.size(); }
+    const RoutePlan& operator[] (unsigned i) const { return elites_[i].plan; }
+    int cost(unsigned i) const { return elites_[i].cost; }
+    const std::vector<int>& route_of(unsigned i) const {
+        return elites_[i].route_of;
+    }
+    // a random member other than rp, -1 if there is none
+    int PickGuide(const RoutePlan &rp) const;
+    // order groups in different routes, from RoutePlan::RouteOf
+    static unsigned Distance(const std::vector<int> &a,
+                             const std::vector<int> &b);
+
+ private:
+    struct Elite {
+        Elite(const RoutePlan &rp, int c): plan(rp), cost(c) { }
+        RoutePlan plan;
+        int cost;
+        std::vector<int> route_of;
+    };
+    unsigned capacity_, min_distance_;
+    std::vector<Elite> elites_;
+};
+#endif
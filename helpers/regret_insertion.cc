@@ -0,0 +1,141 @@
+#include "helpers/regret_insertion.h"
+#include "helpers/vrp_random.h"
+#include <algorithm>
+#include <climits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// stands for the missing options of a group with fewer than k of them
+const int kNoOption = INT_MAX / 64;
+
+struct Candidate {
+    long long regret;
+    int og;     // position in the groups to insert
+    int stamp;
+    bool operator<(const Candidate &c) const { return regret < c.regret; }
+};
+
+// a little noise on the priorities diversifies repeated samples
+long long Noisy(long long regret) {
+    return regret * (950 + VRPRandom::Int(0, 100)) / 1000;
+}
+
+}  // namespace
+
+RegretInsertion::Insertion
+RegretInsertion::BestInsertion(const Route &r, int route_cost, int og) const {
+    Insertion best = { kNoOption, 0, false };
+    int cap = in.VehicleVect(r.get_vehicle()).get_cap();
+    best.fits = r.demand() + in.OrderGroupVect(og).get_demand() <= cap;
+    Route trial(r);
+    for (unsigned p = 0; p <= r.size(); ++p) {
+        trial.insert(p, og);
+        int delta = eval.Cost(trial) - route_cost;
+        trial.erase(p);
+        if (delta < best.delta) {
+            best.delta = delta;
+            best.pos = p;
+        }
+    }
+    return best;
+}
+
+long long RegretInsertion::Regret(const std::vector<Insertion> &row,
+                                  int og) const {
+    std::vector<int> options;
+    bool any_fits = false;
+    for (unsigned r = 0; r < row.size(); ++r)
+        any_fits |= row[r].fits && row[r].delta < kNoOption;
+    for (unsigned r = 0; r < row.size(); ++r)
+        if (row[r].delta < kNoOption && (row[r].fits || !any_fits))
+            options.push_back(row[r].delta);
+    if (!in.OrderGroupVect(og).IsMandatory())
+        options.push_back(eval.UnscheduledCost(og));
+    if (options.empty())
+        return -1;
+    int k = std::min<int>(regret_k, options.size());
+    std::partial_sort(options.begin(), options.begin() + k, options.end());
+    long long regret = 0;
+    for (int i = 1; i < regret_k; ++i)
+        regret += (i < k ? options[i] : kNoOption) - options[0];
+    return regret;
+}
+
+void RegretInsertion::Construct(RoutePlan &rp) const {
+    std::vector<int> groups(in.get_num_ogroup());
+    for (unsigned g = 0; g < groups.size(); ++g)
+        groups[g] = g;
+    Insert(rp, groups);
+}
+
+void RegretInsertion::Insert(RoutePlan &rp,
+                             const std::vector<int> &groups) const {
+    int num_routes = rp.num_routes();
+    int num_og = groups.size();
+    std::vector<int> route_cost(num_routes);
+    for (int r = 0; r < num_routes; ++r)
+        route_cost[r] = eval.Cost(rp[r]);
+
+    // cache[i][r]: best insertion of groups[i] into route r
+    Insertion none = { kNoOption, 0, false };
+    std::vector<std::vector<Insertion> > cache(num_og,
+        std::vector<Insertion>(num_routes, none));
+    std::vector<int> stamp(num_og, 0);
+    std::vector<bool> routed(num_og, false);
+    std::priority_queue<Candidate> queue;
+    for (int i = 0; i < num_og; ++i) {
+        int g = groups[i];
+        for (int r = 0; r < num_routes; ++r)
+            if (in.IsAdmissible(g, r))
+                cache[i][r] = BestInsertion(rp[r], route_cost[r], g);
+        Candidate c = { Noisy(Regret(cache[i], g)), i, 0 };
+        queue.push(c);
+    }
+
+    while (!queue.empty()) {
+        Candidate c = queue.top();
+        queue.pop();
+        int i = c.og, g = groups[i];
+        if (routed[i] || c.stamp != stamp[i])
+            continue;   // stale entry
+        routed[i] = true;
+
+        // best place: a fitting route, the unscheduled list, then any
+        // route for a mandatory group that fits nowhere
+        const std::vector<Insertion> &row = cache[i];
+        int best_route = -1, best_delta = kNoOption;
+        for (int pass = 0; pass < 2 && best_route < 0; ++pass) {
+            for (int r = 0; r < num_routes; ++r) {
+                if ((pass == 0 && !row[r].fits) || row[r].delta >= best_delta)
+                    continue;
+                best_route = r;
+                best_delta = row[r].delta;
+            }
+            if (pass == 0 && !in.OrderGroupVect(g).IsMandatory() &&
+                eval.UnscheduledCost(g) <= best_delta) {
+                best_route = -1;
+                break;
+            }
+        }
+        if (best_route < 0) {
+            rp[rp.size() - 1].push_back(g);
+            continue;
+        }
+        rp[best_route].insert(row[best_route].pos, g);
+        route_cost[best_route] = eval.Cost(rp[best_route]);
+
+        // only the column of the changed route is stale
+        for (int j = 0; j < num_og; ++j) {
+            int h = groups[j];
+            if (routed[j] || !in.IsAdmissible(h, best_route))
+                continue;
+            cache[j][best_route] =
+                BestInsertion(rp[best_route], route_cost[best_route], h);
+            Candidate d = { Noisy(Regret(cache[j], h)), j, ++stamp[j] };
+            queue.push(d);
+        }
+    }
+}
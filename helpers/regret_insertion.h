@@ -0,0 +1,38 @@
+#ifndef _REGRET_INSERTION_H_
+#define _REGRET_INSERTION_H_
+#include <vector>
+#include "data/route.h"
+#include "data/prob_input.h"
+#include "helpers/route_evaluator.h"
+
+// Regret-k insertion constructor. Every unrouted order group keeps its
+// best insertion into each route in a cache; the group whose k best
+// options (the unscheduled list counts as one for optional groups) lose
+// most against its best one is inserted first, at its best place.
+// Groups wait in a priority queue; inserting into a route only
+// invalidates that route's column of the cache. Capacity is kept hard
+// unless a mandatory group fits nowhere.
+class RegretInsertion {
+ public:
+    RegretInsertion(const ProbInput &i, const RouteEvaluator &e, int k = 3):
+        in(i), eval(e), regret_k(k) { }
+    // rp must be empty; its timetable is not updated
+    void Construct(RoutePlan &rp) const;
+    // inserts groups, none of which is in rp, into the routes of rp or
+    // its unscheduled list; the timetable is not updated
+    void Insert(RoutePlan &rp, const std::vector<int> &groups) const;
+    void set_k(int k) { regret_k = k; }
+ private:
+    struct Insertion {
+        int delta;   // change of the route cost
+        int pos;
+        bool fits;   // route capacity respected
+    };
+    Insertion BestInsertion(const Route &r, int route_cost, int og) const;
+    // -1 when the group has no place left at all
+    long long Regret(const std::vector<Insertion> &row, int og) const;
+    const ProbInput &in;
+    const RouteEvaluator &eval;
+    int regret_k;
+};
+#endif
@@ -0,0 +1,143 @@
+#include "helpers/route_cache.h"
+#include <algorithm>
+#include <vector>
+#include "data/billing.h"
+#include "helpers/billing_cost_component.h"
+
+const RouteCache::Data& RouteCache::Get(const RoutePlan &rp,
+                                        unsigned route) {
+    if (data_.size() != rp.size()) {
+        data_.clear();
+        data_.resize(rp.size());
+    }
+    Data &d = data_[route];
+    const Route &r = rp[route];
+    if (d.valid && d.hash == r.hash() && d.client.size() == r.size())
+        return d;
+    unsigned n = r.size();
+    d.walk.resize(n + 2);
+    d.client.resize(n);
+    d.region.resize(n);
+    d.length.resize(n);
+    d.load.resize(n + 1);
+    eval.Start(d.walk[0]);
+    d.load[0] = 0;
+    for (unsigned p = 0; p < n; ++p) {
+        const OrderGroup &o = in.OrderGroupVect(r[p]);
+        d.walk[p + 1] = d.walk[p];
+        eval.Advance(d.walk[p + 1], r[p]);
+        d.client[p] = o.get_client();
+        d.region[p] = in.FindClient(d.client[p]).get_region();
+        d.length[p] = p ? d.length[p - 1] +
+            in.get_distance(d.client[p - 1], d.client[p]) : 0;
+        d.load[p + 1] = d.load[p] + o.get_demand();
+    }
+    d.walk[n + 1] = d.walk[n];
+    d.late_return = eval.Advance(d.walk[n + 1], -1);
+    d.bill = r.IsExcList() ? 0 :
+        in.FindBilling(r.get_vehicle())->GetCostComponent().Cost(r);
+    d.hash = r.hash();
+    d.valid = true;
+    return d;
+}
+
+int RouteCache::Length(const RoutePlan &rp, const Piece *p, unsigned n) {
+    int depot = in.get_depot();
+    int length = 0, from = depot;
+    for (unsigned i = 0; i < n; ++i) {
+        if (p[i].from == p[i].to)
+            continue;
+        const Data &d = Get(rp, p[i].route);
+        length += in.get_distance(from, d.client[p[i].from])
+            + d.length[p[i].to - 1] - d.length[p[i].from];
+        from = d.client[p[i].to - 1];
+    }
+    return length + in.get_distance(from, depot);
+}
+
+int RouteCache::Lateness(const RoutePlan &rp, const Piece *p, unsigned n,
+                         int *late_return) {
+    unsigned size = 0;
+    for (unsigned i = 0; i < n; ++i)
+        size += p[i].to - p[i].from;
+    RouteEvaluator::Walk w = Get(rp, p[0].route).walk[p[0].to];
+    for (unsigned i = 1; i < n; ++i) {
+        const Route &r = rp[p[i].route];
+        const Data &d = Get(rp, p[i].route);
+        // the rest of the new route is the rest of this one
+        bool tail = p[i].to == r.size();
+        for (unsigned j = i + 1; tail && j < n; ++j)
+            tail = p[j].from == p[j].to;
+        for (unsigned k = p[i].from; k <= p[i].to; ++k) {
+            const RouteEvaluator::Walk &o = d.walk[k];
+            if (tail && w.arrive == o.arrive && w.stop == o.stop &&
+                w.client == o.client && w.late.prev == o.late.prev &&
+                w.late.day == o.late.day &&
+                w.late.over_time == o.late.over_time) {
+                *late_return = d.late_return ? size : 0;
+                return w.late.cost + d.walk[r.size() + 1].late.cost
+                    - o.late.cost;
+            }
+            if (k < p[i].to)
+                eval.Advance(w, r[k]);
+        }
+    }
+    *late_return = eval.Advance(w, -1) ? size : 0;
+    return w.late.cost;
+}
+
+int RouteCache::Bill(const RoutePlan &rp, const Piece *p, unsigned n) {
+    const Route &r = rp[p[0].route];
+    const BillingCostComponent &bill =
+        in.FindBilling(r.get_vehicle())->GetCostComponent();
+    if (bill.ByLength())
+        return bill.LengthCost(r, Length(rp, p, n));
+    RouteProfile profile;
+    profile.length = Length(rp, p, n);
+    for (unsigned i = 0; i < n; ++i) {
+        const Data &d = Get(rp, p[i].route);
+        for (unsigned k = p[i].from; k < p[i].to; ++k)
+            profile.Add(d.region[k], d.load[k + 1] - d.load[k]);
+    }
+    return bill.Cost(profile, r.get_vehicle());
+}
+
+RouteCache::Delta RouteCache::Change(const RoutePlan &rp, const Piece *p,
+                                     unsigned n) {
+    const Route &r = rp[p[0].route];
+    const Data &d = Get(rp, p[0].route);
+    unsigned old_size = r.size(), size = 0;
+    int load = 0;
+    for (unsigned i = 0; i < n; ++i) {
+        const Data &piece = Get(rp, p[i].route);
+        size += p[i].to - p[i].from;
+        load += piece.load[p[i].to] - piece.load[p[i].from];
+    }
+
+    Delta delta;
+    delta.cost = Bill(rp, p, n) - d.bill;
+    const Vehicle &v = in.VehicleVect(r.get_vehicle());
+    if (!size && old_size)
+        delta.cost -= v.fixed_cost();
+    else if (size && !old_size)
+        delta.cost += v.fixed_cost();
+
+    int late_return = 0;
+    int lateness = Lateness(rp, p, n, &late_return);
+    delta.cost += RouteEvaluator::kTimeWeight *
+        (lateness - d.walk[old_size + 1].late.cost);
+    delta.late_return = late_return - (d.late_return ? old_size : 0);
+
+    int cap = v.get_cap();
+    delta.cap_excess = std::max(load - cap, 0) -
+        std::max(d.load[old_size] - cap, 0);
+    return delta;
+}
+
+void RouteCache::Splice(const RoutePlan &rp, const Piece *p, unsigned n,
+                        Route &out) const {
+    out.clear();
+    for (unsigned i = 0; i < n; ++i)
+        for (unsigned k = p[i].from; k < p[i].to; ++k)
+            out.push_back(rp[p[i].route][k]);
+}
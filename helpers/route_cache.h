@@ -0,0 +1,59 @@
+#ifndef _ROUTE_CACHE_H_
+#define _ROUTE_CACHE_H_
+#include <stdint.h>
+#include <vector>
+#include "data/route.h"
+#include "data/prob_input.h"
+#include "helpers/route_evaluator.h"
+
+// Prefixes of the routes of a plan, from which the explorers price a
+// changed route without building it. A changed route is given as pieces
+// of stored ones: its length and load come from the arcs at the joins,
+// its time windows resume the walk stored before the first piece and
+// stop as soon as they meet the walk stored for the rest of a route.
+// What is stored of a route is kept while its Zobrist hash stays the
+// same, so no move needs to drop it. Not safe to share among threads.
+class RouteCache {
+ public:
+    // a run of stops [from, to) of a route
+    struct Piece {
+        unsigned route;
+        unsigned from, to;
+    };
+    struct Data {
+        Data(): valid(false) { }
+        bool valid;
+        uint64_t hash;
+        std::vector<RouteEvaluator::Walk> walk;  // after p stops, then home
+        std::vector<int> client;
+        std::vector<int> region;
+        std::vector<int> length;    // from the first stop to stop p
+        std::vector<int> load;      // of the first p stops
+        bool late_return;
+        int bill;
+    };
+    // what a route's cost changes by, date penalties left out
+    struct Delta {
+        int cost;           // bill, fixed cost and time windows, weighted
+        int late_return;    // orders returning late
+        int cap_excess;     // demand over capacity
+    };
+
+    RouteCache(const ProbInput &i, int w): in(i), eval(i, w) { }
+    const Data& Get(const RoutePlan&, unsigned r);
+    // the route made of the n pieces; the first one is the route's own
+    // prefix, maybe empty, and gives it its vehicle
+    int Length(const RoutePlan&, const Piece*, unsigned n);
+    int Lateness(const RoutePlan&, const Piece*, unsigned n,
+                 int *late_return);
+    int Bill(const RoutePlan&, const Piece*, unsigned n);
+    // route p[0].route becoming the n pieces
+    Delta Change(const RoutePlan&, const Piece*, unsigned n);
+    void Splice(const RoutePlan&, const Piece*, unsigned n, Route&) const;
+ private:
+    const ProbInput &in;
+    RouteEvaluator eval;
+    std::vector<Data> data_;
+};
+
+#endif
@@ -0,0 +1,126 @@
+#include "helpers/route_evaluator.h"
+#include <vector>
+#include "data/billing.h"
+#include "helpers/billing_cost_component.h"
+
+void RouteEvaluator::Drive(int from, int to, int *arrive, int *stop) const {
+    if (from == to)
+        return;
+    int ready_time = in.FindClient(to).get_ready_time();
+    *arrive += in.FindClient(from).get_service_time()
+        + in.get_time_dist(from, to);
+    if (*arrive - *stop > 45 * 360) {    // driving rests
+        *arrive += 45 * 60;
+        if (*arrive < ready_time)
+            *arrive = ready_time;
+        *stop = *arrive;
+    } else if (*arrive < ready_time) {
+        if (ready_time - *arrive >= 45 * 60)
+            *stop = ready_time;
+        *arrive = ready_time;
+    }
+}
+
+bool RouteEvaluator::Account(Lateness &l, int tt, int duetime,
+                             int og_size) const {
+    const int final_day = 86399;
+    bool late = false;
+    if (tt < l.prev) {
+        l.over_time = true;
+        l.day++;
+    }
+    if (tt > duetime || l.over_time) {
+        if (l.over_time) {    // arrive time past current day
+            tt += final_day - duetime + l.day * 86400;
+            l.cost += tt * og_size;
+            late = true;
+        } else {
+            l.cost += (tt - duetime) * og_size;
+            late = tt - duetime > 3600;     // later 1 hour
+        }
+    }
+    l.prev = tt;
+    return late;
+}
+
+void RouteEvaluator::Timetable(const Route &r,
+                               std::vector<int> &arrive) const {
+    int arrive_time = in.get_depart_time();
+    int stop_time = in.get_depart_time();
+    int client_from = in.get_depot();
+    unsigned route_size = r.size();
+    arrive.clear();
+    for (unsigned i = 0; i <= route_size; ++i) {
+        int client_to = in.get_depot();
+        if (i < route_size)
+            client_to = in.OrderGroupVect(r[i]).get_client();
+        Drive(client_from, client_to, &arrive_time, &stop_time);
+        arrive.push_back(arrive_time);
+        client_from = client_to;
+    }
+}
+
+int RouteEvaluator::TimeWindowCost(const Route &r,
+                                   const std::vector<int> &arrive,
+                                   int *late_return) const {
+    Lateness l = { in.get_depart_time(), -1, false, 0 };
+    *late_return = 0;
+    for (unsigned i = 0; i <= r.size(); ++i) {
+        int og_size = 1, duetime = in.get_return_time();
+        if (i < r.size()) {
+            const OrderGroup &og = in.OrderGroupVect(r[i]);
+            duetime = in.FindClient(og.get_client()).get_due_time();
+            og_size = og.size();
+        }
+        if (Account(l, arrive[i], duetime, og_size) && i == r.size())
+            *late_return += r.size();
+    }
+    return l.cost;
+}
+
+void RouteEvaluator::Start(Walk &w) const {
+    w.arrive = w.stop = in.get_depart_time();
+    w.client = in.get_depot();
+    Lateness l = { in.get_depart_time(), -1, false, 0 };
+    w.late = l;
+}
+
+bool RouteEvaluator::Advance(Walk &w, int og) const {
+    int client = in.get_depot(), og_size = 1;
+    int duetime = in.get_return_time();
+    if (og >= 0) {
+        const OrderGroup &o = in.OrderGroupVect(og);
+        client = o.get_client();
+        duetime = in.FindClient(client).get_due_time();
+        og_size = o.size();
+    }
+    Drive(w.client, client, &w.arrive, &w.stop);
+    w.client = client;
+    return Account(w.late, w.arrive, duetime, og_size);
+}
+
+int RouteEvaluator::TransportationCost(const Route &r) const {
+    const Billing *cr = in.FindBilling(r.get_vehicle());
+    int cost = cr->GetCostComponent().Cost(r);
+    if (r.size())
+        cost += in.VehicleVect(r.get_vehicle()).fixed_cost();
+    return cost;
+}
+
+int RouteEvaluator::Cost(const Route &r, int *late_return,
+                         int *cap_excess) const {
+    std::vector<int> arrive;
+    Timetable(r, arrive);
+    int cost = kTimeWeight * TimeWindowCost(r, arrive, late_return);
+    cost += vio_wt * *late_return;
+    int date = 0;
+    for (unsigned k = 0; k < r.size(); ++k)
+        date += in.DatePenalty(r[k], r.get_id());
+    cost += kDateWeight * date;
+    cost += TransportationCost(r);
+    int demand = r.demand();
+    int cap = in.VehicleVect(r.get_vehicle()).get_cap();
+    *cap_excess = demand > cap ? demand - cap : 0;
+    cost += kCapWeight * *cap_excess;
+    return cost;
+}
@@ -0,0 +1,66 @@
+#ifndef _ROUTE_EVALUATOR_H_
+#define _ROUTE_EVALUATOR_H_
+#include <vector>
+#include "data/route.h"
+#include "data/prob_input.h"
+
+// Cost of one route exactly as VRPStateManager::CostFunction counts it,
+// for code that builds or changes routes outside a RoutePlan
+// (constructors, neighborhoods). Stateless, safe to share among threads.
+class RouteEvaluator {
+ public:
+    // weights of the cost components
+    static const int kDateWeight = 30;
+    static const int kTimeWeight = 10;
+    static const int kOptionalWeight = 250;
+    static const int kCapWeight = 1;
+
+    // where the time window accounting stands after some arrivals
+    struct Lateness {
+        int prev;       // last arrival, pushed past midnight if overtime
+        int day;        // days past the departure one
+        bool over_time;
+        int cost;       // unweighted, so far
+    };
+    // the timetable walk stopped after a stop, to be resumed from there
+    struct Walk {
+        int arrive, stop, client;
+        Lateness late;
+    };
+
+    RouteEvaluator(const ProbInput &i, int w): in(i), vio_wt(w) { }
+    // arrival time at each stop and back at the depot, with the driving
+    // rest rules
+    void Timetable(const Route&, std::vector<int> &arrive) const;
+    // unweighted; *late_return gets the orders of a late return
+    int TimeWindowCost(const Route&, const std::vector<int> &arrive,
+                       int *late_return) const;
+    // a walk standing at the depot before departure
+    void Start(Walk&) const;
+    // drives on to order group og, or back to the depot if og < 0, and
+    // accounts its time window; true if that arrival makes a late return
+    bool Advance(Walk&, int og) const;
+    // billing plus the fixed cost of a used vehicle
+    int TransportationCost(const Route&) const;
+    // whole contribution of a scheduled route to the cost function
+    int Cost(const Route &r) const {
+        int late_return, cap_excess;
+        return Cost(r, &late_return, &cap_excess);
+    }
+    // the same, also giving the orders returning late and the demand
+    // over capacity, unweighted
+    int Cost(const Route&, int *late_return, int *cap_excess) const;
+    int UnscheduledCost(int og) const {
+        return kOptionalWeight * in.OrderGroupVect(og).get_demand();
+    }
+    int get_vio_weight() const { return vio_wt; }
+ private:
+    // arrival at client to, leaving from at *arrive, last rested at *stop
+    void Drive(int from, int to, int *arrive, int *stop) const;
+    // adds an arrival at tt to the lateness; true if it is over a day
+    // late or more than an hour past duetime
+    bool Account(Lateness&, int tt, int duetime, int og_size) const;
+    const ProbInput &in;
+    int vio_wt;
+};
+#endif
@@ -0,0 +1,244 @@
+#include "helpers/route_pool.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// cheapest per group first
+struct ByCostPerGroup {
+    ByCostPerGroup(const std::vector<int> &c, const std::vector<int> &s):
+        cost(c), size(s) { }
+    bool operator()(int a, int b) const {
+        return (long long)cost[a] * size[b] < (long long)cost[b] * size[a];
+    }
+    const std::vector<int> &cost, &size;
+};
+
+}  // namespace
+
+void RoutePool::Clear() {
+    entries_.clear();
+    index_.clear();
+    by_group_.assign(in.get_num_ogroup(), std::vector<int>());
+}
+
+int RoutePool::Add(const Route &r) {
+    std::unordered_map<uint64_t, int>::const_iterator it =
+        index_.find(r.hash());
+    if (it != index_.end())
+        return it->second;
+    int late_return, cap_excess;
+    int cost = eval.Cost(r, &late_return, &cap_excess);
+    // infeasible ones are remembered too, not to be priced again
+    int e = !late_return && !cap_excess ? NewEntry(r, cost) : -1;
+    index_[r.hash()] = e;
+    return e;
+}
+
+int RoutePool::NewEntry(const Route &r, int cost) {
+    int e = entries_.size();
+    Entry entry;
+    entry.route = r.get_day() * in.get_num_vehicle() + r.get_vehicle();
+    entry.cost = cost;
+    for (unsigned k = 0; k < r.size(); ++k) {
+        entry.groups.push_back(r[k]);
+        by_group_[r[k]].push_back(e);
+    }
+    entries_.push_back(entry);
+    return e;
+}
+
+void RoutePool::Harvest(const RoutePlan &rp) {
+    for (unsigned r = 0; r < rp.num_routes() && index_.size() < capacity_;
+         ++r)
+        if (rp[r].size())
+            Add(rp[r]);
+}
+
+void RoutePool::Clashes(const Selection &sel, const int *adds, unsigned n) {
+    clashes_.clear();
+    for (unsigned i = 0; i < n; ++i) {
+        const Entry &a = entries_[adds[i]];
+        int e = sel.in_route[a.route];
+        if (e >= 0 &&
+            std::find(clashes_.begin(), clashes_.end(), e) == clashes_.end())
+            clashes_.push_back(e);
+        for (unsigned k = 0; k < a.groups.size(); ++k) {
+            int r = sel.cover[a.groups[k]];
+            if (r < 0)
+                continue;
+            e = sel.in_route[r];
+            if (std::find(clashes_.begin(), clashes_.end(), e) ==
+                clashes_.end())
+                clashes_.push_back(e);
+        }
+    }
+}
+
+bool RoutePool::Evaluate(const Selection &sel, const int *adds, unsigned n,
+                         int *delta, int *missing) {
+    ++now_;
+    int d = 0;
+    for (unsigned i = 0; i < n; ++i) {
+        const Entry &a = entries_[adds[i]];
+        d += a.cost;
+        for (unsigned k = 0; k < a.groups.size(); ++k) {
+            int g = a.groups[k];
+            stamp_[g] = now_;
+            if (sel.cover[g] < 0)
+                d -= eval.UnscheduledCost(g);
+        }
+    }
+    Clashes(sel, adds, n);
+    for (unsigned i = 0; i < clashes_.size(); ++i) {
+        const Entry &c = entries_[clashes_[i]];
+        d -= c.cost;
+        for (unsigned k = 0; k < c.groups.size(); ++k) {
+            int g = c.groups[k];
+            if (stamp_[g] == now_)
+                continue;
+            if (in.OrderGroupVect(g).IsMandatory()) {
+                *missing = g;
+                return false;
+            }
+            d += eval.UnscheduledCost(g);
+        }
+    }
+    *delta = d;
+    return true;
+}
+
+void RoutePool::Apply(Selection &sel, const int *adds, unsigned n) {
+    Clashes(sel, adds, n);
+    for (unsigned i = 0; i < clashes_.size(); ++i) {
+        const Entry &c = entries_[clashes_[i]];
+        sel.in_route[c.route] = -1;
+        for (unsigned k = 0; k < c.groups.size(); ++k)
+            sel.cover[c.groups[k]] = -1;
+    }
+    for (unsigned i = 0; i < n; ++i) {
+        const Entry &a = entries_[adds[i]];
+        sel.in_route[a.route] = adds[i];
+        for (unsigned k = 0; k < a.groups.size(); ++k)
+            sel.cover[a.groups[k]] = a.route;
+    }
+}
+
+int RoutePool::Recombine(const RoutePlan &incumbent, RoutePlan &result) {
+    unsigned num_og = in.get_num_ogroup();
+    Selection sel;
+    sel.in_route.assign(incumbent.num_routes(), -1);
+    sel.cover.assign(num_og, -1);
+    for (unsigned r = 0; r < incumbent.num_routes(); ++r)
+        if (incumbent[r].size())
+            sel.in_route[r] = Add(incumbent[r]);
+    // the infeasible ones go after the pooled routes, to be dropped
+    unsigned pooled = entries_.size();
+    int cost = 0;
+    for (unsigned r = 0; r < incumbent.num_routes(); ++r) {
+        if (!incumbent[r].size())
+            continue;
+        int e = sel.in_route[r];
+        if (e < 0)
+            e = sel.in_route[r] = NewEntry(incumbent[r],
+                                           eval.Cost(incumbent[r]));
+        cost += entries_[e].cost;
+        for (unsigned k = 0; k < incumbent[r].size(); ++k)
+            sel.cover[incumbent[r][k]] = r;
+    }
+    for (unsigned g = 0; g < num_og; ++g)
+        if (sel.cover[g] < 0)
+            cost += eval.UnscheduledCost(g);
+
+    std::vector<int> entry_cost, entry_size;
+    for (unsigned e = 0; e < entries_.size(); ++e) {
+        entry_cost.push_back(entries_[e].cost);
+        entry_size.push_back(entries_[e].groups.size());
+    }
+    for (unsigned g = 0; g < num_og; ++g)
+        std::sort(by_group_[g].begin(), by_group_[g].end(),
+                  ByCostPerGroup(entry_cost, entry_size));
+    stamp_.assign(num_og, 0);
+    now_ = 0;
+    std::vector<bool> taken(num_og, false);
+    bool improved = true;
+    while (improved) {
+        improved = false;
+        for (unsigned e = 0; e < entries_.size(); ++e) {
+            const Entry &a = entries_[e];
+            if (sel.in_route[a.route] == (int)e)
+                continue;
+            int adds[2] = { (int)e, -1 };
+            int d, missing;
+            if (Evaluate(sel, adds, 1, &d, &missing)) {
+                if (d < 0) {
+                    Apply(sel, adds, 1);
+                    cost += d;
+                    improved = true;
+                }
+                continue;
+            }
+            // with a second route for the group left out
+            for (unsigned k = 0; k < a.groups.size(); ++k)
+                taken[a.groups[k]] = true;
+            const std::vector<int> &cands = by_group_[missing];
+            for (unsigned c = 0; c < cands.size() && c < kCandidates; ++c) {
+                const Entry &b = entries_[cands[c]];
+                bool apart = b.route != a.route;
+                for (unsigned k = 0; apart && k < b.groups.size(); ++k)
+                    apart = !taken[b.groups[k]];
+                adds[1] = cands[c];
+                if (apart && Evaluate(sel, adds, 2, &d, &missing) && d < 0) {
+                    Apply(sel, adds, 2);
+                    cost += d;
+                    improved = true;
+                    break;
+                }
+            }
+            for (unsigned k = 0; k < a.groups.size(); ++k)
+                taken[a.groups[k]] = false;
+        }
+        // routes of optional groups only may go altogether
+        for (unsigned r = 0; r < sel.in_route.size(); ++r) {
+            int e = sel.in_route[r];
+            if (e < 0)
+                continue;
+            const Entry &a = entries_[e];
+            int d = -a.cost;
+            bool optional = true;
+            for (unsigned k = 0; optional && k < a.groups.size(); ++k) {
+                optional = !in.OrderGroupVect(a.groups[k]).IsMandatory();
+                d += eval.UnscheduledCost(a.groups[k]);
+            }
+            if (optional && d < 0) {
+                sel.in_route[r] = -1;
+                for (unsigned k = 0; k < a.groups.size(); ++k)
+                    sel.cover[a.groups[k]] = -1;
+                cost += d;
+                improved = true;
+            }
+        }
+    }
+
+    for (unsigned r = 0; r < result.size(); ++r)
+        result[r].clear();
+    for (unsigned r = 0; r < result.num_routes(); ++r) {
+        int e = sel.in_route[r];
+        for (unsigned k = 0; e >= 0 && k < entries_[e].groups.size(); ++k)
+            result[r].push_back(entries_[e].groups[k]);
+        eval.Timetable(result[r], result.timetable(r));
+    }
+    for (unsigned g = 0; g < num_og; ++g)
+        if (sel.cover[g] < 0)
+            result[result.size() - 1].push_back(g);
+
+    for (unsigned e = pooled; e < entries_.size(); ++e) {
+        for (unsigned k = 0; k < entries_[e].groups.size(); ++k) {
+            std::vector<int> &with = by_group_[entries_[e].groups[k]];
+            with.erase(std::remove(with.begin(), with.end(), (int)e),
+                       with.end());
+        }
+    }
+    entries_.resize(pooled);
+    return cost;
+}
@@ -0,0 +1,69 @@
+#ifndef _ROUTE_POOL_H_
+#define _ROUTE_POOL_H_
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+#include "data/route.h"
+#include "data/prob_input.h"
+#include "helpers/route_evaluator.h"
+
+// Distinct feasible routes, no late return and no demand over capacity,
+// met on the way, with their exact cost. A route is known by its Route
+// hash, which covers its vehicle and day as well as its stops.
+// Recombine picks a low-cost set of them, at most one per vehicle and
+// day, that covers every mandatory order group exactly once and every
+// optional one at most once, the others going unscheduled.
+class RoutePool {
+ public:
+    RoutePool(const ProbInput &i, const RouteEvaluator &e,
+              unsigned capacity):
+        in(i), eval(e), capacity_(capacity),
+        by_group_(i.get_num_ogroup()), now_(0) { }
+    // adds the new feasible routes of rp while there is room
+    void Harvest(const RoutePlan &rp);
+    // starting from incumbent, whose routes are all taken in first, a
+    // descent that swaps pool routes in, one at a time or two when one
+    // leaves a mandatory group uncovered. The infeasible routes of
+    // incumbent only take part in this call. result gets the plan,
+    // timetable included but not its violations, which are for the
+    // state manager's CostFunction to set; returns its cost.
+    int Recombine(const RoutePlan &incumbent, RoutePlan &result);
+    unsigned size() const { return entries_.size(); }
+    void Clear();
+
+ private:
+    struct Entry {
+        unsigned route;
+        int cost;
+        std::vector<int> groups;
+    };
+    // the current choice of routes during Recombine
+    struct Selection {
+        std::vector<int> in_route;   // entry on each route, -1 for none
+        std::vector<int> cover;      // route of each group, -1 for none
+    };
+    // index of r in the pool, -1 if it is not there and cannot be added
+    int Add(const Route &r);
+    int NewEntry(const Route &r, int cost);
+    // cost change of taking in the given entries, of different routes
+    // and groups, with the selected ones they clash with; false if a
+    // mandatory group would be left uncovered, the first one in *missing
+    bool Evaluate(const Selection &sel, const int *adds, unsigned n,
+                  int *delta, int *missing);
+    void Apply(Selection &sel, const int *adds, unsigned n);
+    // the routes, as their entries, that taking in adds displaces
+    void Clashes(const Selection &sel, const int *adds, unsigned n);
+    // of the entries with group g, the ones two-route swaps try
+    static const unsigned kCandidates = 20;
+    const ProbInput &in;
+    const RouteEvaluator &eval;
+    unsigned capacity_;
+    std::vector<Entry> entries_;
+    std::unordered_map<uint64_t, int> index_;
+    std::vector<std::vector<int> > by_group_;
+    // scratch of Evaluate
+    std::vector<int> clashes_;
+    std::vector<unsigned> stamp_;
+    unsigned now_;
+};
+#endif
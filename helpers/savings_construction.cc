@@ -0,0 +1,290 @@
+#include "helpers/savings_construction.h"
+#include "helpers/vrp_random.h"
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Saving {
+    int saving;
+    int from;   // tail of one trip
+    int to;     // head of the other
+    bool operator<(const Saving &s) const { return saving > s.saving; }
+};
+
+// mandatory groups first, then by decreasing demand
+struct ByPriority {
+    explicit ByPriority(const ProbInput &i): in(i) { }
+    bool operator()(int a, int b) const {
+        const OrderGroup &oa = in.OrderGroupVect(a);
+        const OrderGroup &ob = in.OrderGroupVect(b);
+        if (oa.IsMandatory() != ob.IsMandatory())
+            return oa.IsMandatory();
+        return oa.get_demand() > ob.get_demand();
+    }
+    const ProbInput &in;
+};
+
+}  // namespace
+
+void SavingsConstruction::Construct(RoutePlan &rp) const {
+    std::vector<std::vector<int> > day_groups;
+    std::vector<int> unscheduled;
+    AssignDays(day_groups, unscheduled);
+
+    // days share nothing but the read-only input: each thread writes its
+    // own routes and its own list of left over groups
+    int num_days = day_groups.size();
+    std::vector<std::vector<int> > left(num_days);
+    std::vector<std::thread> workers;
+    for (int d = 0; d < num_days; ++d)
+        workers.push_back(std::thread(&SavingsConstruction::BuildDay, this,
+                                      std::ref(rp), d,
+                                      std::cref(day_groups[d]),
+                                      std::ref(left[d])));
+    for (unsigned t = 0; t < workers.size(); ++t)
+        workers[t].join();
+
+    Route &exc_list = rp[rp.size() - 1];
+    for (unsigned k = 0; k < unscheduled.size(); ++k)
+        exc_list.push_back(unscheduled[k]);
+    for (int d = 0; d < num_days; ++d)
+        for (unsigned k = 0; k < left[d].size(); ++k)
+            exc_list.push_back(left[d][k]);
+}
+
+void
+SavingsConstruction::AssignDays(std::vector<std::vector<int> > &day_groups,
+                                std::vector<int> &unscheduled) const {
+    int num_days = in.get_dayspan(), num_veh = in.get_num_vehicle();
+    int num_og = in.get_num_ogroup();
+    std::vector<int> load(num_days, 0);
+    day_groups.assign(num_days, std::vector<int>());
+
+    std::vector<int> order(num_og);
+    for (int g = 0; g < num_og; ++g)
+        order[g] = g;
+    std::sort(order.begin(), order.end(), ByPriority(in));
+    for (int k = 0; k < num_og; ++k) {
+        int g = order[k];
+        const OrderGroup &o = in.OrderGroupVect(g);
+        const uint64_t *fits = in.FittingVehicles(g);
+        bool any_vehicle = false;
+        for (int w = 0; w < in.get_vehicle_words(); ++w)
+            any_vehicle |= fits[w] != 0;
+        // the emptiest day of least date penalty, loads a bit blurred
+        std::pair<int, int> dw = o.get_dw();
+        int best_day = -1, best_penalty = INT_MAX, best_load = INT_MAX;
+        for (int d = std::max(dw.first - 1, 0);
+             any_vehicle && d < std::min(dw.second, num_days); ++d) {
+            int penalty = in.DatePenalty(g, d * num_veh);
+            int blurred = load[d] + VRPRandom::Int(0, o.get_demand());
+            if (penalty < best_penalty ||
+                (penalty == best_penalty && blurred < best_load)) {
+                best_day = d;
+                best_penalty = penalty;
+                best_load = blurred;
+            }
+        }
+        if (best_day < 0) {
+            unscheduled.push_back(g);
+            continue;
+        }
+        day_groups[best_day].push_back(g);
+        load[best_day] += o.get_demand();
+    }
+}
+
+int SavingsConstruction::MaxCap(const std::vector<uint64_t> &vehicles) const {
+    int cap = 0;
+    for (unsigned w = 0; w < vehicles.size(); ++w)
+        for (uint64_t bits = vehicles[w]; bits; bits &= bits - 1)
+            cap = std::max<int>(cap,
+                in.VehicleVect(w * 64 + LowestBit(bits)).get_cap());
+    return cap;
+}
+
+int SavingsConstruction::Lateness(int day,
+                                  const std::vector<int> &groups) const {
+    Route r(day * in.get_num_vehicle(), false, in);
+    for (unsigned k = 0; k < groups.size(); ++k)
+        r.push_back(groups[k]);
+    std::vector<int> arrive;
+    eval.Timetable(r, arrive);
+    int late_return = 0;
+    int late = eval.TimeWindowCost(r, arrive, &late_return);
+    return late_return ? -1 : late;
+}
+
+void SavingsConstruction::BuildDay(RoutePlan &rp, int day,
+                                   const std::vector<int> &groups,
+                                   std::vector<int> &unscheduled) const {
+    int n = groups.size(), words = in.get_vehicle_words();
+    int num_veh = in.get_num_vehicle(), depot = in.get_depot();
+
+    // one trip per group; trip_of is indexed by position in groups
+    std::vector<Trip> trips(n);
+    std::vector<int> trip_of(n);
+    std::vector<int> client(n);
+    for (int i = 0; i < n; ++i) {
+        const OrderGroup &o = in.OrderGroupVect(groups[i]);
+        const uint64_t *fits = in.FittingVehicles(groups[i]);
+        trips[i].groups.assign(1, i);
+        trips[i].vehicles.assign(fits, fits + words);
+        trips[i].demand = o.get_demand();
+        trips[i].late = std::max(Lateness(day, std::vector<int>(1, groups[i])),
+                                 0);
+        trip_of[i] = i;
+        client[i] = o.get_client();
+    }
+
+    std::vector<Saving> savings;
+    for (int i = 0; i < n; ++i) {
+        int back = in.get_distance(client[i], depot);
+        for (int j = 0; j < n; ++j) {
+            if (i == j)
+                continue;
+            int s = back + in.get_distance(depot, client[j])
+                - in.get_distance(client[i], client[j]);
+            if (s > 0) {
+                Saving sv = { s, i, j };
+                savings.push_back(sv);
+            }
+        }
+    }
+    std::sort(savings.begin(), savings.end());
+
+    std::vector<uint64_t> common(words);
+    std::vector<int> chained, chained_groups;
+    for (unsigned k = 0; k < savings.size(); ++k) {
+        int ti = trip_of[savings[k].from], tj = trip_of[savings[k].to];
+        Trip &a = trips[ti], &b = trips[tj];
+        if (ti == tj || a.groups.back() != savings[k].from ||
+            b.groups.front() != savings[k].to)
+            continue;
+        bool any_vehicle = false;
+        for (int w = 0; w < words; ++w) {
+            common[w] = a.vehicles[w] & b.vehicles[w];
+            any_vehicle |= common[w] != 0;
+        }
+        if (!any_vehicle || a.demand + b.demand > MaxCap(common))
+            continue;
+        chained = a.groups;
+        chained.insert(chained.end(), b.groups.begin(), b.groups.end());
+        chained_groups.clear();
+        for (unsigned p = 0; p < chained.size(); ++p)
+            chained_groups.push_back(groups[chained[p]]);
+        int late = Lateness(day, chained_groups);
+        if (late < 0 || late > a.late + b.late)
+            continue;
+        for (unsigned p = 0; p < b.groups.size(); ++p)
+            trip_of[b.groups[p]] = ti;
+        a.groups.swap(chained);
+        a.vehicles = common;
+        a.demand += b.demand;
+        a.late = late;
+        b.groups.clear();
+    }
+
+    // vehicles for the largest trips first, the cheapest that holds them
+    std::vector<std::pair<int, int> > by_demand;
+    for (int t = 0; t < n; ++t)
+        if (trips[t].groups.size())
+            by_demand.push_back(std::make_pair(-trips[t].demand, t));
+    std::sort(by_demand.begin(), by_demand.end());
+    std::vector<bool> taken(num_veh, false);
+    std::vector<int> left_over;
+    for (unsigned k = 0; k < by_demand.size(); ++k) {
+        const Trip &t = trips[by_demand[k].second];
+        int best = -1, best_cost = INT_MAX;
+        for (int w = 0; w < words; ++w) {
+            for (uint64_t bits = t.vehicles[w]; bits; bits &= bits - 1) {
+                int v = w * 64 + LowestBit(bits);
+                int cap = in.VehicleVect(v).get_cap();
+                if (taken[v] || cap < t.demand)
+                    continue;
+                Route trial(day * num_veh + v, false, in);
+                for (unsigned p = 0; p < t.groups.size(); ++p)
+                    trial.push_back(groups[t.groups[p]]);
+                int cost = eval.Cost(trial);
+                if (cost < best_cost) {
+                    best = v;
+                    best_cost = cost;
+                }
+            }
+        }
+        if (best < 0) {
+            for (unsigned p = 0; p < t.groups.size(); ++p)
+                left_over.push_back(groups[t.groups[p]]);
+            continue;
+        }
+        taken[best] = true;
+        Route &r = rp[day * num_veh + best];
+        for (unsigned p = 0; p < t.groups.size(); ++p)
+            r.push_back(groups[t.groups[p]]);
+    }
+
+    // cheapest insertion of the rest into the routes of the day, within
+    // capacity if possible; optional groups rather stay unscheduled than
+    // cost more than that
+    std::sort(left_over.begin(), left_over.end(), ByPriority(in));
+    for (unsigned k = 0; k < left_over.size(); ++k) {
+        int g = left_over[k];
+        const OrderGroup &o = in.OrderGroupVect(g);
+        const uint64_t *fits = in.FittingVehicles(g);
+        int best_route = -1, best_pos = 0, best_delta = INT_MAX;
+        bool best_holds = false;
+        for (int w = 0; w < words; ++w) {
+            for (uint64_t bits = fits[w]; bits; bits &= bits - 1) {
+                int v = w * 64 + LowestBit(bits);
+                Route trial(rp[day * num_veh + v]);
+                int cap = in.VehicleVect(v).get_cap();
+                bool holds = trial.demand() + o.get_demand() <= cap;
+                if (best_holds && !holds)
+                    continue;
+                int route_cost = eval.Cost(trial);
+                for (unsigned p = 0; p <= trial.size(); ++p) {
+                    trial.insert(p, g);
+                    int delta = eval.Cost(trial) - route_cost;
+                    trial.erase(p);
+                    if (delta < best_delta || (holds && !best_holds)) {
+                        best_route = day * num_veh + v;
+                        best_pos = p;
+                        best_delta = delta;
+                        best_holds = holds;
+                    }
+                }
+            }
+        }
+        if (best_route < 0 || (!o.IsMandatory() &&
+            (!best_holds || eval.UnscheduledCost(g) <= best_delta))) {
+            unscheduled.push_back(g);
+            continue;
+        }
+        rp[best_route].insert(best_pos, g);
+    }
+
+    // drop optional groups that cost their route more than leaving them
+    for (int v = 0; v < num_veh; ++v) {
+        Route &r = rp[day * num_veh + v];
+        int route_cost = eval.Cost(r);
+        for (unsigned p = 0; p < r.size(); ) {
+            int g = r[p];
+            if (in.OrderGroupVect(g).IsMandatory()) {
+                ++p;
+                continue;
+            }
+            r.erase(p);
+            int cost = eval.Cost(r);
+            if (route_cost - cost > eval.UnscheduledCost(g)) {
+                unscheduled.push_back(g);
+                route_cost = cost;
+            } else {
+                r.insert(p++, g);
+            }
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef _SAVINGS_CONSTRUCTION_H_
+#define _SAVINGS_CONSTRUCTION_H_
+#include <vector>
+#include <stdint.h>
+#include "data/route.h"
+#include "data/prob_input.h"
+#include "helpers/route_evaluator.h"
+
+// Clarke-Wright savings constructor. Every group first gets a day of its
+// date window; then each day is built in a thread of its own: groups
+// start on trips of their own and trips are chained, tail to head, by
+// decreasing distance saved, as long as some vehicle reaches and holds
+// all of their groups and no lateness is added. Trips get their vehicles
+// largest first and best fit; the groups of a trip left without one are
+// inserted cheapest into the routes of the day, or left unscheduled.
+class SavingsConstruction {
+ public:
+    SavingsConstruction(const ProbInput &i, const RouteEvaluator &e):
+        in(i), eval(e) { }
+    // rp must be empty; its timetable is not updated
+    void Construct(RoutePlan &rp) const;
+ private:
+    struct Trip {
+        std::vector<int> groups;
+        std::vector<uint64_t> vehicles;  // fitting every group
+        int demand;
+        int late;                        // unweighted time window cost
+    };
+    // groups of each day; ties between days of equal date penalty are
+    // broken at random so that samples differ
+    void AssignDays(std::vector<std::vector<int> > &day_groups,
+                    std::vector<int> &unscheduled) const;
+    void BuildDay(RoutePlan &rp, int day, const std::vector<int> &groups,
+                  std::vector<int> &unscheduled) const;
+    // largest capacity among the vehicles, 0 if none
+    int MaxCap(const std::vector<uint64_t> &vehicles) const;
+    // -1 when the trip returns late
+    int Lateness(int day, const std::vector<int> &groups) const;
+    const ProbInput &in;
+    const RouteEvaluator &eval;
+};
+#endif
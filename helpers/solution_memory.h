@@ -0,0 +1,34 @@
+#ifndef _SOLUTION_MEMORY_H_
+#define _SOLUTION_MEMORY_H_
+#include <stdint.h>
+#include <unordered_set>
+#include "data/route.h"
+
+// The plans a search has been through, by RoutePlan::hash(); two plans
+// agreeing on all 64 bits count as one.
+class SolutionMemory {
+ public:
+    SolutionMemory(): revisits_(0) { }
+    // true the first time rp is seen, otherwise counts a revisit
+    bool Visit(const RoutePlan &rp) {
+        if (seen_.insert(rp.hash()).second)
+            return true;
+        ++revisits_;
+        return false;
+    }
+    bool Visited(const RoutePlan &rp) const {
+        return seen_.count(rp.hash()) > 0;
+    }
+    void Clear() {
+        seen_.clear();
+        revisits_ = 0;
+    }
+    unsigned size() const { return seen_.size(); }
+    unsigned revisits() const { return revisits_; }
+
+ private:
+    std::unordered_set<uint64_t> seen_;
+    unsigned revisits_;
+};
+
+#endif
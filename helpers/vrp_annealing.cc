@@ -0,0 +1,229 @@
+#include "helpers/vrp_annealing.h"
+#include "helpers/vrp_random.h"
+#include <cmath>
+
+SampledMoveSearch::SampledMoveSearch(const ProbInput &in,
+                                     VRPStateManager &e_sm,
+                                     InsMoveNeighborhoodExplorer &ins,
+                                     InterSwapNeighborhoodExplorer &inter,
+                                     IntraSwapNeighborhoodExplorer &intra,
+                                     std::string name,
+                                     std::string description):
+    Runner<ProbInput, RoutePlan>(in, e_sm, name, description),
+    ins_ne(ins), inter_ne(inter), intra_ne(intra), neighborhood(0),
+    current_move_cost(0), time_budget(0.0) { }
+
+void SampledMoveSearch::InitializeRun() {
+    Runner<ProbInput, RoutePlan>::InitializeRun();
+    this->best_state = this->current_state;
+    this->best_state_cost = this->current_state_cost;
+    this->iteration_of_best = this->number_of_iterations;
+    start = std::chrono::steady_clock::now();
+}
+
+bool SampledMoveSearch::StopCriterion() {
+    if (time_budget <= 0.0)
+        return false;
+    std::chrono::duration<double> spent =
+        std::chrono::steady_clock::now() - start;
+    return spent.count() >= time_budget;
+}
+
+void SampledMoveSearch::SelectMove() {
+    neighborhood = VRPRandom::Int(0, 2);
+    if (neighborhood == 0) {
+        ins_ne.RandomMove(this->current_state, ins_move);
+        current_move_cost =
+            ins_ne.DeltaCostFunction(this->current_state, ins_move);
+    } else if (neighborhood == 1) {
+        inter_ne.RandomMove(this->current_state, inter_move);
+        current_move_cost =
+            inter_ne.DeltaCostFunction(this->current_state, inter_move);
+    } else {
+        intra_ne.RandomMove(this->current_state, intra_move);
+        current_move_cost =
+            intra_ne.DeltaCostFunction(this->current_state, intra_move);
+    }
+}
+
+void SampledMoveSearch::MakeMove() {
+    if (neighborhood == 0)
+        ins_ne.MakeMove(this->current_state, ins_move);
+    else if (neighborhood == 1)
+        inter_ne.MakeMove(this->current_state, inter_move);
+    else
+        intra_ne.MakeMove(this->current_state, intra_move);
+    this->current_state_cost += current_move_cost;
+}
+
+void SampledMoveSearch::StoreMove() {
+    if (this->current_state_cost < this->best_state_cost) {
+        this->best_state = this->current_state;
+        this->best_state_cost = this->current_state_cost;
+        this->iteration_of_best = this->number_of_iterations;
+    }
+}
+
+double SampledMoveSearch::MeanUphillDelta(unsigned samples) {
+    double sum = 0.0;
+    unsigned uphill = 0;
+    for (unsigned k = 0; k < samples; ++k) {
+        SelectMove();
+        if (current_move_cost > 0) {
+            sum += current_move_cost;
+            ++uphill;
+        }
+    }
+    return uphill ? sum / uphill : 1.0;
+}
+
+VRPSimulatedAnnealing::VRPSimulatedAnnealing(
+        const ProbInput &in, VRPStateManager &e_sm,
+        InsMoveNeighborhoodExplorer &ins,
+        InterSwapNeighborhoodExplorer &inter,
+        IntraSwapNeighborhoodExplorer &intra,
+        std::string name, CLParser &cl):
+    SampledMoveSearch(in, e_sm, ins, inter, intra, name,
+                      "Simulated annealing"),
+    start_temperature(0.0), min_temperature(1.0), cooling_rate(0.98),
+    neighbors_sampled(1000), temperature(0.0),
+    sa_arguments("sa_" + name, "sa_" + name, false),
+    arg_start_temperature("start_temperature", "st", false),
+    arg_min_temperature("min_temperature", "mt", false),
+    arg_cooling_rate("cooling_rate", "cr", false),
+    arg_neighbors_sampled("neighbors_sampled", "ns", false),
+    arg_time_budget("time_budget", "tb", false) {
+    sa_arguments.AddArgument(arg_start_temperature);
+    sa_arguments.AddArgument(arg_min_temperature);
+    sa_arguments.AddArgument(arg_cooling_rate);
+    sa_arguments.AddArgument(arg_neighbors_sampled);
+    sa_arguments.AddArgument(arg_time_budget);
+    cl.AddArgument(sa_arguments);
+    cl.MatchArgument(sa_arguments);
+    if (sa_arguments.IsSet()) {
+        if (arg_start_temperature.IsSet())
+            start_temperature = arg_start_temperature.GetValue();
+        if (arg_min_temperature.IsSet())
+            min_temperature = arg_min_temperature.GetValue();
+        if (arg_cooling_rate.IsSet())
+            cooling_rate = arg_cooling_rate.GetValue();
+        if (arg_neighbors_sampled.IsSet())
+            neighbors_sampled = arg_neighbors_sampled.GetValue();
+        if (arg_time_budget.IsSet())
+            time_budget = arg_time_budget.GetValue();
+    }
+}
+
+void VRPSimulatedAnnealing::ReadParameters(std::istream &is,
+                                           std::ostream &os) {
+    os << "SIMULATED ANNEALING -- INPUT PARAMETERS" << std::endl;
+    os << "  Start temperature (0 to calibrate): ";
+    is >> start_temperature;
+    os << "  Min temperature: ";
+    is >> min_temperature;
+    os << "  Cooling rate: ";
+    is >> cooling_rate;
+    os << "  Neighbors sampled at each temperature: ";
+    is >> neighbors_sampled;
+}
+
+void VRPSimulatedAnnealing::Print(std::ostream &os) const {
+    os << "Simulated Annealing: " << this->name << std::endl;
+    os << "  Max iterations: " << this->max_iteration << std::endl;
+    os << "  Start temperature: " << start_temperature << std::endl;
+    os << "  Min temperature: " << min_temperature << std::endl;
+    os << "  Cooling rate: " << cooling_rate << std::endl;
+    os << "  Neighbors sampled: " << neighbors_sampled << std::endl;
+    os << "  Time budget: " << time_budget << std::endl;
+}
+
+void VRPSimulatedAnnealing::InitializeRun() {
+    SampledMoveSearch::InitializeRun();
+    temperature = start_temperature;
+    if (temperature <= 0.0)     // exp(-mean / T) = 1/2
+        temperature = MeanUphillDelta(100) / std::log(2.0);
+}
+
+bool VRPSimulatedAnnealing::StopCriterion() {
+    return temperature < min_temperature ||
+        SampledMoveSearch::StopCriterion();
+}
+
+void VRPSimulatedAnnealing::UpdateIterationCounter() {
+    SampledMoveSearch::UpdateIterationCounter();
+    if (this->number_of_iterations % neighbors_sampled == 0)
+        temperature *= cooling_rate;
+}
+
+bool VRPSimulatedAnnealing::Accept(int delta) {
+    return delta <= 0 ||
+        VRPRandom::Double(0.0, 1.0) < std::exp(-delta / temperature);
+}
+
+VRPLateAcceptance::VRPLateAcceptance(const ProbInput &in,
+                                     VRPStateManager &e_sm,
+                                     InsMoveNeighborhoodExplorer &ins,
+                                     InterSwapNeighborhoodExplorer &inter,
+                                     IntraSwapNeighborhoodExplorer &intra,
+                                     std::string name, CLParser &cl):
+    SampledMoveSearch(in, e_sm, ins, inter, intra, name, "Late acceptance"),
+    history_length(1000), max_idle_iteration(20000),
+    la_arguments("la_" + name, "la_" + name, false),
+    arg_history_length("history_length", "hl", false),
+    arg_max_idle_iteration("max_idle_iteration", "mii", false),
+    arg_time_budget("time_budget", "tb", false) {
+    la_arguments.AddArgument(arg_history_length);
+    la_arguments.AddArgument(arg_max_idle_iteration);
+    la_arguments.AddArgument(arg_time_budget);
+    cl.AddArgument(la_arguments);
+    cl.MatchArgument(la_arguments);
+    if (la_arguments.IsSet()) {
+        if (arg_history_length.IsSet())
+            history_length = arg_history_length.GetValue();
+        if (arg_max_idle_iteration.IsSet())
+            max_idle_iteration = arg_max_idle_iteration.GetValue();
+        if (arg_time_budget.IsSet())
+            time_budget = arg_time_budget.GetValue();
+    }
+}
+
+void VRPLateAcceptance::ReadParameters(std::istream &is, std::ostream &os) {
+    os << "LATE ACCEPTANCE -- INPUT PARAMETERS" << std::endl;
+    os << "  History length: ";
+    is >> history_length;
+    os << "  Max number of idle iterations: ";
+    is >> max_idle_iteration;
+}
+
+void VRPLateAcceptance::Print(std::ostream &os) const {
+    os << "Late Acceptance: " << this->name << std::endl;
+    os << "  Max iterations: " << this->max_iteration << std::endl;
+    os << "  History length: " << history_length << std::endl;
+    os << "  Max idle iteration: " << max_idle_iteration << std::endl;
+    os << "  Time budget: " << time_budget << std::endl;
+}
+
+void VRPLateAcceptance::InitializeRun() {
+    SampledMoveSearch::InitializeRun();
+    history.assign(history_length ? history_length : 1,
+                   this->current_state_cost);
+}
+
+bool VRPLateAcceptance::StopCriterion() {
+    return this->number_of_iterations - this->iteration_of_best >=
+        max_idle_iteration || SampledMoveSearch::StopCriterion();
+}
+
+void VRPLateAcceptance::UpdateIterationCounter() {
+    // the slot of the last iteration gets the cost it ended with
+    if (this->number_of_iterations)
+        history[(this->number_of_iterations - 1) % history.size()] =
+            this->current_state_cost;
+    SampledMoveSearch::UpdateIterationCounter();
+}
+
+bool VRPLateAcceptance::Accept(int delta) {
+    int cost = this->current_state_cost + delta;
+    return delta <= 0 ||
+        cost <= history[(this->number_of_iterations - 1) % history.size()];
+}
@@ -0,0 +1,116 @@
+#ifndef _VRP_ANNEALING_H_
+#define _VRP_ANNEALING_H_
+#include <runners/Runner.hh>
+#include <utils/CLParser.hh>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "data/route.h"
+#include "data/prob_input.h"
+#include "data/neighbor.h"
+#include "helpers/vrp_state_manager.h"
+#include "helpers/vrp_neighborhood_explorer.h"
+
+// Runners that draw one random move per iteration from the three
+// neighborhoods and price it with DeltaCostFunction, so an iteration
+// costs O(route length) rather than a full neighborhood scan. The
+// subclasses decide which moves are accepted. Both stop on their own
+// criterion, after max_iteration or when the time budget is spent.
+class SampledMoveSearch: public Runner<ProbInput, RoutePlan> {
+ public:
+    void SetTimeBudget(double seconds) { time_budget = seconds; }
+ protected:
+    SampledMoveSearch(const ProbInput &in,
+                      VRPStateManager &e_sm,
+                      InsMoveNeighborhoodExplorer &ins,
+                      InterSwapNeighborhoodExplorer &inter,
+                      IntraSwapNeighborhoodExplorer &intra,
+                      std::string name,
+                      std::string description);
+    void InitializeRun();
+    bool StopCriterion();
+    void SelectMove();
+    bool AcceptableMove() { return Accept(current_move_cost); }
+    void MakeMove();
+    void StoreMove();
+    virtual bool Accept(int delta) = 0;
+    // mean cost increase of a few random moves, to scale the criteria
+    double MeanUphillDelta(unsigned samples);
+    InsMoveNeighborhoodExplorer &ins_ne;
+    InterSwapNeighborhoodExplorer &inter_ne;
+    IntraSwapNeighborhoodExplorer &intra_ne;
+    int neighborhood;   // the one current_move_cost comes from
+    InsMove ins_move;
+    InterSwap inter_move;
+    IntraSwap intra_move;
+    int current_move_cost;
+    double time_budget;  // seconds, 0 for none
+    std::chrono::steady_clock::time_point start;
+};
+
+// Simulated annealing with geometric cooling: the temperature drops by
+// cooling_rate every neighbors_sampled iterations down to
+// min_temperature. With no start temperature given, one is picked so
+// that an average uphill move is accepted half of the time.
+class VRPSimulatedAnnealing: public SampledMoveSearch {
+ public:
+    VRPSimulatedAnnealing(const ProbInput &in,
+                          VRPStateManager &e_sm,
+                          InsMoveNeighborhoodExplorer &ins,
+                          InterSwapNeighborhoodExplorer &inter,
+                          IntraSwapNeighborhoodExplorer &intra,
+                          std::string name,
+                          CLParser &cl);
+    void ReadParameters(std::istream &is = std::cin,
+                        std::ostream &os = std::cout);
+    void Print(std::ostream &os = std::cout) const;
+ protected:
+    void InitializeRun();
+    bool StopCriterion();
+    void UpdateIterationCounter();
+    bool Accept(int delta);
+ private:
+    double start_temperature, min_temperature, cooling_rate;
+    unsigned neighbors_sampled;
+    double temperature;
+    ArgumentGroup sa_arguments;
+    ValArgument<double> arg_start_temperature;
+    ValArgument<double> arg_min_temperature;
+    ValArgument<double> arg_cooling_rate;
+    ValArgument<int> arg_neighbors_sampled;
+    ValArgument<double> arg_time_budget;
+};
+
+// Late acceptance hill climbing: a move is accepted when the new cost is
+// no worse than the current one or than the cost history_length
+// iterations ago.
+class VRPLateAcceptance: public SampledMoveSearch {
+ public:
+    VRPLateAcceptance(const ProbInput &in,
+                      VRPStateManager &e_sm,
+                      InsMoveNeighborhoodExplorer &ins,
+                      InterSwapNeighborhoodExplorer &inter,
+                      IntraSwapNeighborhoodExplorer &intra,
+                      std::string name,
+                      CLParser &cl);
+    void ReadParameters(std::istream &is = std::cin,
+                        std::ostream &os = std::cout);
+    void Print(std::ostream &os = std::cout) const;
+    void SetMaxIdleIteration(unsigned long n) { max_idle_iteration = n; }
+ protected:
+    void InitializeRun();
+    bool StopCriterion();
+    void UpdateIterationCounter();
+    bool Accept(int delta);
+ private:
+    unsigned history_length;
+    unsigned long max_idle_iteration;
+    std::vector<int> history;
+    ArgumentGroup la_arguments;
+    ValArgument<int> arg_history_length;
+    ValArgument<int> arg_max_idle_iteration;
+    ValArgument<double> arg_time_budget;
+};
+
+#endif
@@ -0,0 +1,149 @@
+#include "helpers/vrp_lns.h"
+#include "helpers/vrp_random.h"
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+LargeNeighborhoodSearch::LargeNeighborhoodSearch(const ProbInput &in,
+                                                 VRPStateManager &e_sm,
+                                                 std::string name,
+                                                 CLParser &cl):
+    Runner<ProbInput, RoutePlan>(in, e_sm, name, "Ruin and recreate"),
+    vrp_sm(e_sm), recreate(in, e_sm.get_evaluator()), trial(in),
+    trial_cost(0), min_removal(3), max_removal(20),
+    max_idle_iteration(200),
+    lns_arguments("lns_" + name, "lns_" + name, false),
+    arg_max_idle_iteration("max_idle_iteration", "mii", false),
+    arg_max_removal("max_removal", "mrm", false) {
+    lns_arguments.AddArgument(arg_max_idle_iteration);
+    lns_arguments.AddArgument(arg_max_removal);
+    cl.AddArgument(lns_arguments);
+    cl.MatchArgument(lns_arguments);
+    if (lns_arguments.IsSet()) {
+        if (arg_max_idle_iteration.IsSet())
+            max_idle_iteration = arg_max_idle_iteration.GetValue();
+        if (arg_max_removal.IsSet())
+            max_removal = arg_max_removal.GetValue();
+    }
+}
+
+void LargeNeighborhoodSearch::ReadParameters(std::istream &is,
+                                             std::ostream &os) {
+    os << "LARGE NEIGHBORHOOD SEARCH -- INPUT PARAMETERS" << std::endl;
+    os << "  Max number of idle iterations: ";
+    is >> max_idle_iteration;
+    os << "  Max number of groups removed: ";
+    is >> max_removal;
+}
+
+void LargeNeighborhoodSearch::Print(std::ostream &os) const {
+    os << "Large Neighborhood Search: " << this->name << std::endl;
+    os << "  Max iterations: " << this->max_iteration << std::endl;
+    os << "  Max idle iteration: " << max_idle_iteration << std::endl;
+    os << "  Groups removed: " << min_removal << " to " << max_removal
+       << std::endl;
+}
+
+void LargeNeighborhoodSearch::InitializeRun() {
+    Runner<ProbInput, RoutePlan>::InitializeRun();
+    this->best_state = this->current_state;
+    this->best_state_cost = this->current_state_cost;
+    this->iteration_of_best = this->number_of_iterations;
+}
+
+bool LargeNeighborhoodSearch::StopCriterion() {
+    return this->number_of_iterations - this->iteration_of_best >=
+        max_idle_iteration;
+}
+
+void LargeNeighborhoodSearch::SelectMove() {
+    trial = this->current_state;
+    std::vector<int> removed;
+    Ruin(trial, static_cast<RuinKind>(VRPRandom::Int(0, NUM_RUINS - 1)),
+         removed);
+    recreate.Insert(trial, removed);
+    vrp_sm.UpdateTimeTable(trial);
+    trial_cost = vrp_sm.CostFunction(trial);
+}
+
+bool LargeNeighborhoodSearch::AcceptableMove() {
+    return trial_cost <= this->current_state_cost;
+}
+
+void LargeNeighborhoodSearch::MakeMove() {
+    this->current_state = trial;
+    this->current_state_cost = trial_cost;
+}
+
+void LargeNeighborhoodSearch::StoreMove() {
+    if (this->current_state_cost < this->best_state_cost) {
+        this->best_state = this->current_state;
+        this->best_state_cost = this->current_state_cost;
+        this->iteration_of_best = this->number_of_iterations;
+    }
+}
+
+int LargeNeighborhoodSearch::Relatedness(RuinKind kind, int og, int day,
+                                         int seed, int seed_day) const {
+    int client = this->in.OrderGroupVect(og).get_client();
+    int seed_client = this->in.OrderGroupVect(seed).get_client();
+    const Client &c = this->in.FindClient(client);
+    const Client &s = this->in.FindClient(seed_client);
+    if (kind == TIME_RUIN)
+        return std::abs(day - seed_day) * 86400 +
+            std::abs(c.get_ready_time() - s.get_ready_time());
+    // REGION_RUIN: the seed's region first, then by distance
+    int d = this->in.get_distance(seed_client, client);
+    return c.get_region() == s.get_region() ? d / 2 : d;
+}
+
+void LargeNeighborhoodSearch::Ruin(RoutePlan &rp, RuinKind kind,
+                                   std::vector<int> &removed) const {
+    int num_veh = this->in.get_num_vehicle();
+    // scheduled groups with their routes
+    std::vector<std::pair<int, int> > scheduled;
+    for (unsigned r = 0; r < rp.num_routes(); ++r)
+        for (unsigned k = 0; k < rp[r].size(); ++k)
+            scheduled.push_back(std::make_pair(rp[r][k], r));
+    std::vector<bool> out(this->in.get_num_ogroup(), false);
+    int n = scheduled.size();
+    int q = std::min(n, VRPRandom::Int(min_removal, max_removal));
+
+    if (n && kind == ROUTE_RUIN) {
+        int r = scheduled[VRPRandom::Int(0, n - 1)].second;
+        for (unsigned k = 0; k < rp[r].size(); ++k)
+            out[rp[r][k]] = true;
+    } else if (n && kind == RANDOM_RUIN) {
+        for (int k = 0; k < q; ++k) {
+            std::swap(scheduled[k], scheduled[VRPRandom::Int(k, n - 1)]);
+            out[scheduled[k].first] = true;
+        }
+    } else if (n) {
+        const std::pair<int, int> &seed = scheduled[VRPRandom::Int(0, n - 1)];
+        std::vector<std::pair<int, int> > by_relatedness;
+        for (int k = 0; k < n; ++k)
+            by_relatedness.push_back(std::make_pair(
+                Relatedness(kind, scheduled[k].first,
+                            scheduled[k].second / num_veh,
+                            seed.first, seed.second / num_veh),
+                scheduled[k].first));
+        std::partial_sort(by_relatedness.begin(), by_relatedness.begin() + q,
+                          by_relatedness.end());
+        for (int k = 0; k < q; ++k)
+            out[by_relatedness[k].second] = true;
+    }
+
+    // the unscheduled groups get another chance as well
+    for (unsigned r = 0; r < rp.size(); ++r) {
+        Route &route = rp[r];
+        for (unsigned k = 0; k < route.size(); ) {
+            if (r == rp.size() - 1 || out[route[k]]) {
+                removed.push_back(route[k]);
+                route.erase(k);
+            } else {
+                ++k;
+            }
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef _VRP_LNS_H_
+#define _VRP_LNS_H_
+#include <runners/Runner.hh>
+#include <utils/CLParser.hh>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "data/route.h"
+#include "data/prob_input.h"
+#include "helpers/vrp_state_manager.h"
+#include "helpers/regret_insertion.h"
+
+// Ruin and recreate. Every iteration removes a few related order groups
+// (at random, a whole route, groups close in time or close in space) and
+// puts them back, with the unscheduled ones, by regret insertion over
+// the cached best insertion of each group into each route. The new plan
+// replaces the current one unless it costs more.
+class LargeNeighborhoodSearch: public Runner<ProbInput, RoutePlan> {
+ public:
+    enum RuinKind { RANDOM_RUIN, ROUTE_RUIN, TIME_RUIN, REGION_RUIN,
+                    NUM_RUINS };
+    LargeNeighborhoodSearch(const ProbInput &in,
+                            VRPStateManager &e_sm,
+                            std::string name,
+                            CLParser &cl);
+    ~LargeNeighborhoodSearch() { }
+    void ReadParameters(std::istream &is = std::cin,
+                        std::ostream &os = std::cout);
+    void Print(std::ostream &os = std::cout) const;
+    void SetMaxIdleIteration(unsigned long n) { max_idle_iteration = n; }
+    void set_removal(int lo, int hi) { min_removal = lo; max_removal = hi; }
+ protected:
+    void InitializeRun();
+    bool StopCriterion();
+    void SelectMove();
+    bool AcceptableMove();
+    void MakeMove();
+    void StoreMove();
+ private:
+    // takes the groups out of rp, scheduled ones chosen by kind
+    void Ruin(RoutePlan &rp, RuinKind kind, std::vector<int> &removed) const;
+    // distance-like measure between two scheduled groups
+    int Relatedness(RuinKind kind, int og, int day, int seed,
+                    int seed_day) const;
+    VRPStateManager &vrp_sm;
+    RegretInsertion recreate;
+    RoutePlan trial;
+    int trial_cost;
+    int min_removal, max_removal;
+    unsigned long max_idle_iteration;
+    ArgumentGroup lns_arguments;
+    ValArgument<int> arg_max_idle_iteration;
+    ValArgument<int> arg_max_removal;
+};
+
+#endif
@@ -1,10 +1,11 @@
 #include "helpers/vrp_neighborhood_explorer.h"
-#include <utils/Random.hh>
+#include "helpers/vrp_random.h"
 #include <string>
 #include <vector>
 #include <algorithm>
 #include <fstream>
 #include <cassert>
+#include <climits>
 #include "data/billing.h"
 #include "helpers/billing_cost_component.h"
 
@@ -26,10 +27,9 @@ bool InsMoveNeighborhoodExplorer::FeasibleMove(const RoutePlan &rp,
     //     return false;
     if (mv.new_route == mv.old_route)
         return false;
-    if (rp[mv.new_route].IsExcList()) {
-        if (in.OrderGroupVect(mv.order).IsMandatory())
-            return false;
-    } else {
+    if (!in.IsAdmissible(mv.order, mv.new_route))
+        return false;
+    if (!rp[mv.new_route].IsExcList()) {
         // f << "here " << mv << std::endl;
         int vehicle = rp[mv.new_route].get_vehicle();
         unsigned vehicle_cap = in.VehicleVect(vehicle).get_cap();
@@ -42,16 +42,16 @@ bool InsMoveNeighborhoodExplorer::FeasibleMove(const RoutePlan &rp,
 
 void InsMoveNeighborhoodExplorer::AnyRandomMove(const RoutePlan &rp,
                                                 InsMove &mv) const {
-    mv.old_route = Random::Int(0, rp.size() - 1);
+    mv.old_route = VRPRandom::Int(0, rp.size() - 1);
     mv.old_pos = mv.order = 0;
     if (rp[mv.old_route].size()) {
-        mv.old_pos = Random::Int(0, rp[mv.old_route].size() - 1);
+        mv.old_pos = VRPRandom::Int(0, rp[mv.old_route].size() - 1);
         mv.order = rp[mv.old_route][mv.old_pos];
     }
-    mv.new_route = Random::Int(0, rp.size() - 1);
+    mv.new_route = VRPRandom::Int(0, rp.size() - 1);
     mv.new_pos = 0;     // for null routes
     if (rp[mv.new_route].size())
-        mv.new_pos = Random::Int(0, rp[mv.new_route].size());
+        mv.new_pos = VRPRandom::Int(0, rp[mv.new_route].size());
 }
 
 void InsMoveNeighborhoodExplorer::FirstMove(const RoutePlan &rp,
@@ -192,17 +192,8 @@ InsMoveNeighborhoodExplorer::DeltaViolations(const RoutePlan &rp,
 int
 InsMoveNeighborhoodExplorer::DeltaDateViolationCost(const RoutePlan &rp,
                                         const InsMove &mv, int weight) const {
-    int delta = 0;
-    const OrderGroup& o = in.OrderGroupVect(mv.order);
-    unsigned og_demand = o.get_demand();
-    if (!rp[mv.old_route].IsExcList()) {
-        unsigned old_day = rp[mv.old_route].get_day();
-        delta -= (1 - o.IsDayFeasible(old_day)) * og_demand;
-    }
-    if (!rp[mv.new_route].IsExcList()) {
-        unsigned new_day = rp[mv.new_route].get_day();
-        delta += (1 - o.IsDayFeasible(new_day)) * og_demand;
-    }
+    int delta = in.DatePenalty(mv.order, mv.new_route)
+        - in.DatePenalty(mv.order, mv.old_route);
     return (weight * delta);
 }
 
@@ -373,11 +364,8 @@ bool InterSwapNeighborhoodExplorer::FeasibleMove(const RoutePlan &rp,
 #endif
     if (!rp[mv.route1].size() || !rp[mv.route2].size())
         return false;
-    if (rp[mv.route1].IsExcList() &&
-        in.OrderGroupVect(mv.ord2).IsMandatory())
-        return false;
-    else if (rp[mv.route2].IsExcList() &&
-             in.OrderGroupVect(mv.ord1).IsMandatory())
+    if (!in.IsAdmissible(mv.ord2, mv.route1) ||
+        !in.IsAdmissible(mv.ord1, mv.route2))
         return false;
     if (mv.route1 == mv.route2)
         return false;
@@ -419,16 +407,16 @@ bool InterSwapNeighborhoodExplorer::FeasibleMove(const RoutePlan &rp,
 
 void InterSwapNeighborhoodExplorer::AnyRandomMove(const RoutePlan &rp,
                                                 InterSwap &mv) const {
-    mv.route1 = Random::Int(0, rp.size() - 1);
+    mv.route1 = VRPRandom::Int(0, rp.size() - 1);
     mv.pos1 = mv.ord1 = 0;
     if (rp[mv.route1].size()) {
-        mv.pos1 = Random::Int(0, rp[mv.route1].size() - 1);
+        mv.pos1 = VRPRandom::Int(0, rp[mv.route1].size() - 1);
         mv.ord1 = rp[mv.route1][mv.pos1];
     }
-    mv.route2 = Random::Int(0, rp.size() - 1);
+    mv.route2 = VRPRandom::Int(0, rp.size() - 1);
     mv.pos2 = mv.ord2 = 0;
     if (rp[mv.route2].size()) {
-        mv.pos2 = Random::Int(0, rp[mv.route2].size() - 1);
+        mv.pos2 = VRPRandom::Int(0, rp[mv.route2].size() - 1);
         mv.ord2 = rp[mv.route2][mv.pos2];
     }
 }
@@ -515,7 +503,7 @@ bool InterSwapNeighborhoodExplorer::AnyNextMove(const RoutePlan &rp,
 void
 InterSwapNeighborhoodExplorer::MakeMove(RoutePlan &rp,
                                       const InterSwap &mv) const {
-    std::swap(rp[mv.route1][mv.pos1], rp[mv.route2][mv.pos2]);
+    rp[mv.route1].SwapOrder(mv.pos1, rp[mv.route2], mv.pos2);
     // update timetable
     if (!rp[mv.route1].IsExcList())
         UpdateRouteTimetable(rp.timetable(mv.route1), rp[mv.route1]);
@@ -530,7 +518,7 @@ InterSwapNeighborhoodExplorer::DeltaCostFunction(const RoutePlan &rp,
     routes_.clear();
     routes_.push_back(rp[mv.route1]);
     routes_.push_back(rp[mv.route2]);
-    std::swap(routes_[0][mv.pos1], routes_[1][mv.pos2]);
+    routes_[0].SwapOrder(mv.pos1, routes_[1], mv.pos2);
     timetable_.clear();
     timetable_.resize(2);
     if (!routes_[0].IsExcList())
@@ -582,20 +570,10 @@ InterSwapNeighborhoodExplorer::DeltaViolations(const RoutePlan &rp,
 int
 InterSwapNeighborhoodExplorer::DeltaDateViolationCost(const RoutePlan &rp,
                                         const InterSwap &mv, int weight) const {
-    int delta = 0;
-    const OrderGroup& ord1 = in.OrderGroupVect(mv.ord1);
-    const OrderGroup& ord2 = in.OrderGroupVect(mv.ord2);
-    unsigned old_day = rp[mv.route1].get_day();
-    unsigned new_day = rp[mv.route2].get_day();
-    int ord1_demand = ord1.get_demand(), ord2_demand = ord2.get_demand();
-    if (!rp[mv.route1].IsExcList()) {
-        delta -= (1 - ord1.IsDayFeasible(old_day)) * ord1_demand;
-        delta += (1 - ord2.IsDayFeasible(old_day)) * ord2_demand;
-    }
-    if (!rp[mv.route2].IsExcList()) {
-        delta -= (1 - ord2.IsDayFeasible(new_day)) * ord2_demand;
-        delta += (1 - ord1.IsDayFeasible(new_day)) * ord1_demand;
-    }
+    int delta = in.DatePenalty(mv.ord2, mv.route1)
+        - in.DatePenalty(mv.ord1, mv.route1)
+        + in.DatePenalty(mv.ord1, mv.route2)
+        - in.DatePenalty(mv.ord2, mv.route2);
     return (weight * delta);
 }
 
@@ -757,14 +735,14 @@ bool IntraSwapNeighborhoodExplorer::FeasibleMove(const RoutePlan &rp,
 
 void IntraSwapNeighborhoodExplorer::AnyRandomMove(const RoutePlan &rp,
                                                 IntraSwap &mv) const {
-    mv.route = Random::Int(0, rp.size() - 1);
+    mv.route = VRPRandom::Int(0, rp.size() - 1);
     if (rp[mv.route].size() < 2) {
         mv.pos1 = mv.pos2 = 0;
         mv.ord1 = mv.ord2 = 0;
         return;
     }
-    mv.pos1 = Random::Int(0, rp[mv.route].size() - 1);
-    mv.pos2 = Random::Int(0, rp[mv.route].size() - 1);
+    mv.pos1 = VRPRandom::Int(0, rp[mv.route].size() - 1);
+    mv.pos2 = VRPRandom::Int(0, rp[mv.route].size() - 1);
     mv.ord1 = rp[mv.route][mv.pos1];
     mv.ord2 = rp[mv.route][mv.pos2];
     return;
@@ -825,7 +803,7 @@ bool IntraSwapNeighborhoodExplorer::AnyNextMove(const RoutePlan &rp,
 void
 IntraSwapNeighborhoodExplorer::MakeMove(RoutePlan &rp,
                                       const IntraSwap &mv) const {
-    std::swap(rp[mv.route][mv.pos1], rp[mv.route][mv.pos2]);
+    rp[mv.route].SwapOrder(mv.pos1, rp[mv.route], mv.pos2);
     // update timetable
     UpdateRouteTimetable(rp.timetable(mv.route), rp[mv.route]);
 }
@@ -836,7 +814,7 @@ IntraSwapNeighborhoodExplorer::DeltaCostFunction(const RoutePlan &rp,
     // ugly reduntant data
     routes_.clear();
     routes_.push_back(rp[mv.route]);
-    std::swap(routes_[0][mv.pos1], routes_[0][mv.pos2]);
+    routes_[0].SwapOrder(mv.pos1, routes_[0], mv.pos2);
     timetable_.clear();
     timetable_.resize(1);
     if (!routes_[0].IsExcList())
@@ -933,3 +911,1384 @@ IntraSwapNeighborhoodExplorer::DeltaLateReturnCost(const RoutePlan &rp,
 
     return (weight * delta);
 }
+
+// 2-opt Implementation
+
+void TwoOptNeighborhoodExplorer::RandomMove(const RoutePlan &rp,
+                                            TwoOptMove &mv) const {
+    do {
+        AnyRandomMove(rp, mv);
+    } while (!FeasibleMove(rp, mv));
+}
+
+bool TwoOptNeighborhoodExplorer::FeasibleMove(const RoutePlan &rp,
+                                              const TwoOptMove &mv) const {
+    if (rp[mv.route].IsExcList())
+        return false;
+    if (mv.pos1 >= mv.pos2 || mv.pos2 >= rp[mv.route].size())
+        return false;
+    return true;
+}
+
+void TwoOptNeighborhoodExplorer::AnyRandomMove(const RoutePlan &rp,
+                                               TwoOptMove &mv) const {
+    mv.route = VRPRandom::Int(0, rp.size() - 1);
+    if (rp[mv.route].size() < 2) {
+        mv.pos1 = mv.pos2 = 0;
+        mv.ord1 = mv.ord2 = 0;
+        return;
+    }
+    mv.pos1 = VRPRandom::Int(0, rp[mv.route].size() - 2);
+    mv.pos2 = VRPRandom::Int(mv.pos1 + 1, rp[mv.route].size() - 1);
+    mv.ord1 = rp[mv.route][mv.pos1];
+    mv.ord2 = rp[mv.route][mv.pos2];
+}
+
+void TwoOptNeighborhoodExplorer::FirstMove(const RoutePlan &rp,
+                                           TwoOptMove &mv) const {
+    mv.route = 0;
+    mv.pos1 = 0;
+    mv.pos2 = 1;
+    mv.ord1 = mv.ord2 = 0;
+    if (!FeasibleMove(rp, mv)) {
+        NextMove(rp, mv);
+    } else {
+        mv.ord1 = rp[mv.route][mv.pos1];
+        mv.ord2 = rp[mv.route][mv.pos2];
+    }
+}
+
+bool TwoOptNeighborhoodExplorer::NextMove(const RoutePlan &rp,
+                                          TwoOptMove &mv) const {
+    bool not_last = true;
+    do {
+       not_last = AnyNextMove(rp, mv);
+    } while (!FeasibleMove(rp, mv) && not_last);
+    if (not_last) {
+        mv.ord1 = rp[mv.route][mv.pos1];
+        mv.ord2 = rp[mv.route][mv.pos2];
+    }
+    return not_last;
+}
+
+bool TwoOptNeighborhoodExplorer::AnyNextMove(const RoutePlan &rp,
+                                             TwoOptMove &mv) const {
+    unsigned route_size = rp[mv.route].size();
+    if (route_size > 1 && mv.pos2 < route_size - 1) {
+        mv.pos2++;
+    } else if (route_size > 1 && mv.pos1 < route_size - 2) {
+        mv.pos1++;
+        mv.pos2 = mv.pos1 + 1;
+    } else if (mv.route < rp.size() - 1) {
+        mv.route++;
+        mv.pos1 = 0;
+        mv.pos2 = 1;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void
+TwoOptNeighborhoodExplorer::MakeMove(RoutePlan &rp,
+                                     const TwoOptMove &mv) const {
+    for (unsigned i = mv.pos1, j = mv.pos2; i < j; ++i, --j)
+        rp[mv.route].SwapOrder(i, rp[mv.route], j);
+    // update timetable
+    UpdateRouteTimetable(rp.timetable(mv.route), rp[mv.route]);
+    cached_ = false;
+}
+
+void TwoOptNeighborhoodExplorer::Prepare(const RoutePlan &rp,
+                                         unsigned route) const {
+    if (scanning_ && cached_ && cached_route_ == route)
+        return;
+    const Route &r = rp[route];
+    unsigned n = r.size();
+    walk_.resize(n + 1);
+    client_.resize(n);
+    forward_.resize(n);
+    backward_.resize(n);
+    eval.Start(walk_[0]);
+    for (unsigned p = 0; p < n; ++p) {
+        walk_[p + 1] = walk_[p];
+        eval.Advance(walk_[p + 1], r[p]);
+        client_[p] = in.OrderGroupVect(r[p]).get_client();
+        forward_[p] = backward_[p] = 0;
+        if (p) {
+            forward_[p] = forward_[p - 1]
+                + in.get_distance(client_[p - 1], client_[p]);
+            backward_[p] = backward_[p - 1]
+                + in.get_distance(client_[p], client_[p - 1]);
+        }
+    }
+    RouteEvaluator::Walk back = walk_[n];
+    late_return_ = eval.Advance(back, -1) ? n : 0;
+    walk_.push_back(back);
+    cached_route_ = route;
+    cached_ = true;
+}
+
+int
+TwoOptNeighborhoodExplorer::DeltaCostFunction(const RoutePlan &rp,
+                                              const TwoOptMove &mv) const {
+    Prepare(rp, mv.route);
+    const Route &r = rp[mv.route];
+    unsigned n = r.size(), i = mv.pos1, j = mv.pos2;
+
+    // length: the arcs into and out of the segment and the segment itself
+    int depot = in.get_depot();
+    int before = i ? client_[i - 1] : depot;
+    int after = j + 1 < n ? client_[j + 1] : depot;
+    int old_length = in.get_distance(before, client_[i])
+        + forward_[j] - forward_[i] + in.get_distance(client_[j], after);
+    int new_length = in.get_distance(before, client_[j])
+        + backward_[j] - backward_[i] + in.get_distance(client_[i], after);
+    const Billing *cr = in.FindBilling(r.get_vehicle());
+    int delta = cr->GetCostComponent().LengthCost(r, new_length - old_length);
+
+    // time windows: through the reversed segment, then along the rest
+    // until the walk is the stored one again
+    RouteEvaluator::Walk w = walk_[i];
+    for (unsigned k = j + 1; k-- > i; )
+        eval.Advance(w, r[k]);
+    int late_return = 0, tw_cost = 0;
+    unsigned k = j + 1;
+    for (;;) {
+        const RouteEvaluator::Walk &o = walk_[k];
+        if (w.arrive == o.arrive && w.stop == o.stop &&
+            w.client == o.client && w.late.prev == o.late.prev &&
+            w.late.day == o.late.day && w.late.over_time == o.late.over_time) {
+            tw_cost = w.late.cost + walk_[n + 1].late.cost - o.late.cost;
+            late_return = late_return_;
+            break;
+        }
+        if (k == n) {       // back to the depot
+            if (eval.Advance(w, -1))
+                late_return = n;
+            tw_cost = w.late.cost;
+            break;
+        }
+        eval.Advance(w, r[k++]);
+    }
+    delta += RouteEvaluator::kTimeWeight *
+        (tw_cost - walk_[n + 1].late.cost);
+
+    delta_cap = 0;
+    delta_num_order_late_return = late_return - late_return_;
+    delta_vio_ = vio_wt * delta_num_order_late_return;
+    return delta + delta_vio_;
+}
+
+int
+TwoOptNeighborhoodExplorer::DeltaObjective(const RoutePlan &rp,
+                                           const TwoOptMove &mv) const {
+    int delta = DeltaCostFunction(rp, mv);
+    return delta - delta_vio_;
+}
+
+int
+TwoOptNeighborhoodExplorer::DeltaViolations(const RoutePlan &rp,
+                                            const TwoOptMove &mv) const {
+    DeltaCostFunction(rp, mv);
+    return delta_vio_;
+}
+
+int TwoOptNeighborhoodExplorer::BestMove(const RoutePlan &rp,
+        TwoOptMove &mv,
+        ProhibitionManager<RoutePlan, TwoOptMove> &pm) const {
+    scanning_ = true;
+    cached_ = false;
+    int delta = TabuNeighborhoodExplorer<TwoOptMove>::BestMove(rp, mv, pm);
+    scanning_ = false;
+    return delta;
+}
+
+// CROSS Exchange Implementation
+
+void CrossExchangeNeighborhoodExplorer::RandomMove(const RoutePlan &rp,
+                                                   CrossExchange &mv) const {
+    // a move needs two routes of a day, not both empty
+    unsigned num_veh = in.get_num_vehicle();
+    bool any = false;
+    for (unsigned r = 0; num_veh > 1 && !any && r < rp.num_routes(); ++r)
+        any = rp[r].size() > 0;
+    if (!any)
+        throw EmptyNeighborhood("no two routes of a day to exchange");
+    do {
+        AnyRandomMove(rp, mv);
+    } while (!FeasibleMove(rp, mv));
+}
+
+bool CrossExchangeNeighborhoodExplorer::FeasibleMove(const RoutePlan &rp,
+                                                     const CrossExchange &mv) const {
+    if (mv.route1 >= mv.route2 || mv.route2 >= rp.size())
+        return false;
+    const Route &r1 = rp[mv.route1], &r2 = rp[mv.route2];
+    if (r1.IsExcList() || r2.IsExcList() || r1.get_day() != r2.get_day())
+        return false;
+    if (mv.pos1 + mv.len1 > r1.size() || mv.pos2 + mv.len2 > r2.size())
+        return false;
+    if (!mv.len1 && !mv.len2)
+        return false;
+    const RouteCache::Data &d1 = cache_.Get(rp, mv.route1);
+    const RouteCache::Data &d2 = cache_.Get(rp, mv.route2);
+    int seg1 = d1.load[mv.pos1 + mv.len1] - d1.load[mv.pos1];
+    int seg2 = d2.load[mv.pos2 + mv.len2] - d2.load[mv.pos2];
+    int cap1 = in.VehicleVect(r1.get_vehicle()).get_cap();
+    int cap2 = in.VehicleVect(r2.get_vehicle()).get_cap();
+    if (d1.load[r1.size()] - seg1 + seg2 > cap1 ||
+        d2.load[r2.size()] - seg2 + seg1 > cap2)
+        return false;
+    if (Refused(rp, mv.route1, mv.route2, mv.pos1 + mv.len1) !=
+        Refused(rp, mv.route1, mv.route2, mv.pos1))
+        return false;
+    if (Refused(rp, mv.route2, mv.route1, mv.pos2 + mv.len2) !=
+        Refused(rp, mv.route2, mv.route1, mv.pos2))
+        return false;
+    return true;
+}
+
+void CrossExchangeNeighborhoodExplorer::FillOrders(const RoutePlan &rp,
+                                                   CrossExchange &mv) const {
+    mv.ord1 = mv.ord2 = -1;
+    if (mv.route1 < rp.size() && mv.pos1 < rp[mv.route1].size())
+        mv.ord1 = rp[mv.route1][mv.pos1];
+    if (mv.route2 < rp.size() && mv.pos2 < rp[mv.route2].size())
+        mv.ord2 = rp[mv.route2][mv.pos2];
+}
+
+void CrossExchangeNeighborhoodExplorer::AnyRandomMove(const RoutePlan &rp,
+                                                      CrossExchange &mv) const {
+    int num_veh = in.get_num_vehicle();
+    int day = VRPRandom::Int(0, rp.num_routes() / num_veh - 1);
+    int v1 = VRPRandom::Int(0, num_veh - 1), v2 = v1;
+    if (num_veh > 1) {
+        v2 = VRPRandom::Int(0, num_veh - 2);
+        if (v2 >= v1)
+            ++v2;
+    }
+    mv.route1 = day * num_veh + std::min(v1, v2);
+    mv.route2 = day * num_veh + std::max(v1, v2);
+    unsigned *pos[2] = { &mv.pos1, &mv.pos2 }, *len[2] = { &mv.len1, &mv.len2 };
+    unsigned route[2] = { mv.route1, mv.route2 };
+    for (int k = 0; k < 2; ++k) {
+        unsigned size = rp[route[k]].size();
+        *pos[k] = VRPRandom::Int(0, size);
+        unsigned rest = size - *pos[k];
+        unsigned l = VRPRandom::Int(0, CrossExchange::kMaxLen + 1);
+        *len[k] = l > CrossExchange::kMaxLen ? rest : std::min(l, rest);
+    }
+    FillOrders(rp, mv);
+}
+
+void CrossExchangeNeighborhoodExplorer::FirstMove(const RoutePlan &rp,
+                                                  CrossExchange &mv) const {
+    mv.route1 = 0;
+    mv.route2 = 1;
+    mv.pos1 = mv.len1 = mv.pos2 = mv.len2 = 0;
+    FillOrders(rp, mv);
+    if (!FeasibleMove(rp, mv))
+        NextMove(rp, mv);
+}
+
+bool CrossExchangeNeighborhoodExplorer::NextMove(const RoutePlan &rp,
+                                                 CrossExchange &mv) const {
+    bool not_last = true;
+    do {
+        not_last = AnyNextMove(rp, mv);
+    } while (!FeasibleMove(rp, mv) && not_last);
+    return not_last;
+}
+
+bool CrossExchangeNeighborhoodExplorer::NextLen(unsigned &len, unsigned pos,
+                                                unsigned size) const {
+    if (pos + len >= size)
+        return false;
+    if (len < CrossExchange::kMaxLen)
+        ++len;
+    else
+        len = size - pos;
+    return true;
+}
+
+bool CrossExchangeNeighborhoodExplorer::AnyNextMove(const RoutePlan &rp,
+                                                    CrossExchange &mv) const {
+    unsigned num_veh = in.get_num_vehicle();
+    unsigned size1 = rp[mv.route1].size(), size2 = rp[mv.route2].size();
+    if (NextLen(mv.len2, mv.pos2, size2)) {
+        FillOrders(rp, mv);
+        return true;
+    }
+    mv.len2 = 0;
+    if (mv.pos2 < size2) {
+        mv.pos2++;
+        FillOrders(rp, mv);
+        return true;
+    }
+    mv.pos2 = 0;
+    if (NextLen(mv.len1, mv.pos1, size1)) {
+        FillOrders(rp, mv);
+        return true;
+    }
+    mv.len1 = 0;
+    if (mv.pos1 < size1) {
+        mv.pos1++;
+        FillOrders(rp, mv);
+        return true;
+    }
+    mv.pos1 = 0;
+    // the next pair of routes of a day
+    if (mv.route2 % num_veh < num_veh - 1) {
+        mv.route2++;
+    } else {
+        do {
+            mv.route1++;
+        } while (mv.route1 < rp.num_routes() &&
+                 mv.route1 % num_veh == num_veh - 1);
+        if (mv.route1 >= rp.num_routes())
+            return false;
+        mv.route2 = mv.route1 + 1;
+    }
+    FillOrders(rp, mv);
+    return true;
+}
+
+int CrossExchangeNeighborhoodExplorer::Refused(const RoutePlan &rp,
+                                               unsigned from, unsigned to,
+                                               unsigned p) const {
+    int k = from < to ? 0 : 1;
+    const Route &r = rp[from];
+    if (refused_route_[k][0] != from || refused_route_[k][1] != to ||
+        refused_hash_[k] != r.hash() || refused_[k].size() != r.size() + 1) {
+        refused_[k].resize(r.size() + 1);
+        refused_[k][0] = 0;
+        for (unsigned i = 0; i < r.size(); ++i)
+            refused_[k][i + 1] = refused_[k][i] + !in.IsAdmissible(r[i], to);
+        refused_route_[k][0] = from;
+        refused_route_[k][1] = to;
+        refused_hash_[k] = r.hash();
+    }
+    return refused_[k][p];
+}
+
+void CrossExchangeNeighborhoodExplorer::Pieces(const RoutePlan &rp,
+                                               const CrossExchange &mv,
+                                               Piece *p1, Piece *p2) const {
+    unsigned size1 = rp[mv.route1].size(), size2 = rp[mv.route2].size();
+    Piece a[3] = { { mv.route1, 0, mv.pos1 },
+                   { mv.route2, mv.pos2, mv.pos2 + mv.len2 },
+                   { mv.route1, mv.pos1 + mv.len1, size1 } };
+    Piece b[3] = { { mv.route2, 0, mv.pos2 },
+                   { mv.route1, mv.pos1, mv.pos1 + mv.len1 },
+                   { mv.route2, mv.pos2 + mv.len2, size2 } };
+    std::copy(a, a + 3, p1);
+    std::copy(b, b + 3, p2);
+}
+
+int CrossExchangeNeighborhoodExplorer::DeltaRoute(const RoutePlan &rp,
+                                                  const Piece *p) const {
+    RouteCache::Delta d = cache_.Change(rp, p, 3);
+    delta_num_order_late_return += d.late_return;
+    delta_cap += d.cap_excess;
+    return d.cost;
+}
+
+void
+CrossExchangeNeighborhoodExplorer::MakeMove(RoutePlan &rp,
+                                            const CrossExchange &mv) const {
+    Piece p1[3], p2[3];
+    Pieces(rp, mv, p1, p2);
+    Route r1(rp[mv.route1]), r2(rp[mv.route2]);
+    cache_.Splice(rp, p1, 3, r1);
+    cache_.Splice(rp, p2, 3, r2);
+    rp[mv.route1] = r1;
+    rp[mv.route2] = r2;
+    // update timetable
+    UpdateRouteTimetable(rp.timetable(mv.route1), rp[mv.route1]);
+    UpdateRouteTimetable(rp.timetable(mv.route2), rp[mv.route2]);
+}
+
+int
+CrossExchangeNeighborhoodExplorer::DeltaCostFunction(const RoutePlan &rp,
+                                                     const CrossExchange &mv) const {
+    Piece p1[3], p2[3];
+    Pieces(rp, mv, p1, p2);
+    delta_cap = 0;
+    delta_num_order_late_return = 0;
+    int delta = DeltaRoute(rp, p1) + DeltaRoute(rp, p2);
+    delta_vio_ = RouteEvaluator::kCapWeight * delta_cap +
+        vio_wt * delta_num_order_late_return;
+    return delta + delta_vio_;
+}
+
+int
+CrossExchangeNeighborhoodExplorer::DeltaObjective(const RoutePlan &rp,
+                                                  const CrossExchange &mv) const {
+    int delta = DeltaCostFunction(rp, mv);
+    return delta - delta_vio_;
+}
+
+int
+CrossExchangeNeighborhoodExplorer::DeltaViolations(const RoutePlan &rp,
+                                                   const CrossExchange &mv) const {
+    DeltaCostFunction(rp, mv);
+    return delta_vio_;
+}
+
+// Route Swap Implementation
+
+RouteSwapNeighborhoodExplorer::Summary::Summary(const ProbInput &in,
+                                                const Route &r):
+    size(r.size()), profile(in, r),
+    date(in.get_dayspan(), 0), fits(in.get_vehicle_words(), ~0ULL) {
+    int num_veh = in.get_num_vehicle();
+    for (unsigned k = 0; k < r.size(); ++k) {
+        for (unsigned d = 0; d < date.size(); ++d)
+            date[d] += in.DatePenalty(r[k], d * num_veh);
+        const uint64_t *row = in.FittingVehicles(r[k]);
+        for (unsigned w = 0; w < fits.size(); ++w)
+            fits[w] &= row[w];
+    }
+}
+
+void RouteSwapNeighborhoodExplorer::RandomMove(const RoutePlan &rp,
+                                               RouteSwap &mv) const {
+    do {
+        unsigned r1 = VRPRandom::Int(0, rp.num_routes() - 1);
+        unsigned r2 = VRPRandom::Int(0, rp.num_routes() - 1);
+        mv.route1 = std::min(r1, r2);
+        mv.route2 = std::max(r1, r2);
+    } while (!FeasibleMove(rp, mv));
+}
+
+void RouteSwapNeighborhoodExplorer::Summaries(const RoutePlan &rp,
+                                              const RouteSwap &mv,
+                                              const Summary **s1,
+                                              const Summary **s2) const {
+    if (scanning_) {
+        *s1 = &summary_[mv.route1];
+        *s2 = &summary_[mv.route2];
+        return;
+    }
+    local_.clear();
+    local_.push_back(Summary(in, rp[mv.route1]));
+    local_.push_back(Summary(in, rp[mv.route2]));
+    *s1 = &local_[0];
+    *s2 = &local_[1];
+}
+
+bool RouteSwapNeighborhoodExplorer::FeasibleMove(const RoutePlan &rp,
+                                                 const RouteSwap &mv) const {
+    if (mv.route1 >= mv.route2 || mv.route2 >= rp.num_routes())
+        return false;
+    if (!rp[mv.route1].size() && !rp[mv.route2].size())
+        return false;
+    const Summary *s1, *s2;
+    Summaries(rp, mv, &s1, &s2);
+    int v1 = rp[mv.route1].get_vehicle(), v2 = rp[mv.route2].get_vehicle();
+    // every group must fit the other vehicle, and so must the loads
+    if (!(s1->fits[v2 / 64] >> (v2 % 64) & 1) ||
+        !(s2->fits[v1 / 64] >> (v1 % 64) & 1))
+        return false;
+    if (s1->profile.load > static_cast<int>(in.VehicleVect(v2).get_cap()) ||
+        s2->profile.load > static_cast<int>(in.VehicleVect(v1).get_cap()))
+        return false;
+    return true;
+}
+
+void RouteSwapNeighborhoodExplorer::FirstMove(const RoutePlan &rp,
+                                              RouteSwap &mv) const {
+    mv.route1 = 0;
+    mv.route2 = 1;
+    if (!FeasibleMove(rp, mv))
+        NextMove(rp, mv);
+}
+
+bool RouteSwapNeighborhoodExplorer::NextMove(const RoutePlan &rp,
+                                             RouteSwap &mv) const {
+    bool not_last = true;
+    do {
+        not_last = AnyNextMove(rp, mv);
+    } while (!FeasibleMove(rp, mv) && not_last);
+    return not_last;
+}
+
+bool RouteSwapNeighborhoodExplorer::AnyNextMove(const RoutePlan &rp,
+                                                RouteSwap &mv) const {
+    if (mv.route2 < rp.num_routes() - 1) {
+        mv.route2++;
+    } else if (mv.route1 < rp.num_routes() - 2) {
+        mv.route1++;
+        mv.route2 = mv.route1 + 1;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void
+RouteSwapNeighborhoodExplorer::MakeMove(RoutePlan &rp,
+                                        const RouteSwap &mv) const {
+    Route r1(rp[mv.route1]), r2(rp[mv.route2]);
+    rp[mv.route1].clear();
+    for (unsigned k = 0; k < r2.size(); ++k)
+        rp[mv.route1].push_back(r2[k]);
+    rp[mv.route2].clear();
+    for (unsigned k = 0; k < r1.size(); ++k)
+        rp[mv.route2].push_back(r1[k]);
+    // the timetables do not depend on the vehicle or the day
+    rp.timetable(mv.route1).swap(rp.timetable(mv.route2));
+}
+
+int RouteSwapNeighborhoodExplorer::CostIn(const Summary &s, const Route &r,
+                                          int *cap_excess) const {
+    *cap_excess = 0;
+    if (!s.size)
+        return 0;
+    int vehicle = r.get_vehicle();
+    const Vehicle &v = in.VehicleVect(vehicle);
+    int cost = in.FindBilling(vehicle)->GetCostComponent().Cost(s.profile,
+                                                                vehicle);
+    cost += v.fixed_cost();
+    cost += RouteEvaluator::kDateWeight * s.date[r.get_day()];
+    int cap = v.get_cap();
+    if (s.profile.load > cap)
+        *cap_excess = s.profile.load - cap;
+    return cost;
+}
+
+int
+RouteSwapNeighborhoodExplorer::DeltaCostFunction(const RoutePlan &rp,
+                                                 const RouteSwap &mv) const {
+    const Summary *s1, *s2;
+    Summaries(rp, mv, &s1, &s2);
+    const Route &r1 = rp[mv.route1], &r2 = rp[mv.route2];
+    int cap[4];
+    int delta = CostIn(*s1, r2, &cap[0]) + CostIn(*s2, r1, &cap[1])
+        - CostIn(*s1, r1, &cap[2]) - CostIn(*s2, r2, &cap[3]);
+    delta_cap = cap[0] + cap[1] - cap[2] - cap[3];
+    delta_num_order_late_return = 0;
+    delta_vio_ = RouteEvaluator::kCapWeight * delta_cap;
+    return delta + delta_vio_;
+}
+
+int
+RouteSwapNeighborhoodExplorer::DeltaObjective(const RoutePlan &rp,
+                                              const RouteSwap &mv) const {
+    int delta = DeltaCostFunction(rp, mv);
+    return delta - delta_vio_;
+}
+
+int
+RouteSwapNeighborhoodExplorer::DeltaViolations(const RoutePlan &rp,
+                                               const RouteSwap &mv) const {
+    DeltaCostFunction(rp, mv);
+    return delta_vio_;
+}
+
+int RouteSwapNeighborhoodExplorer::BestMove(const RoutePlan &rp,
+        RouteSwap &mv,
+        ProhibitionManager<RoutePlan, RouteSwap> &pm) const {
+    summary_.clear();
+    for (unsigned r = 0; r < rp.size(); ++r)
+        summary_.push_back(Summary(in, rp[r]));
+    scanning_ = true;
+    int delta = TabuNeighborhoodExplorer<RouteSwap>::BestMove(rp, mv, pm);
+    scanning_ = false;
+    return delta;
+}
+
+// Or-opt Segment Relocation Implementation
+
+void OrOptNeighborhoodExplorer::RandomMove(const RoutePlan &rp,
+                                           OrOptMove &mv) const {
+    do {
+        AnyRandomMove(rp, mv);
+    } while (!FeasibleMove(rp, mv));
+}
+
+bool OrOptNeighborhoodExplorer::FeasibleMove(const RoutePlan &rp,
+                                             const OrOptMove &mv) const {
+    const Route &from = rp[mv.old_route], &to = rp[mv.new_route];
+    if (!mv.len || mv.old_pos + mv.len > from.size())
+        return false;
+    // unscheduled groups are not a sequence, they leave one at a time
+    if (from.IsExcList() && mv.len > 1)
+        return false;
+    if (mv.new_route == mv.old_route) {
+        if (from.IsExcList() || mv.new_pos == mv.old_pos ||
+            mv.new_pos > from.size() - mv.len)
+            return false;
+        return true;
+    }
+    if (mv.new_pos > to.size())
+        return false;
+    for (unsigned k = 0; k < mv.len; ++k)
+        if (!in.IsAdmissible(mv.orders[k], mv.new_route))
+            return false;
+    if (!to.IsExcList()) {
+        int vehicle_cap = in.VehicleVect(to.get_vehicle()).get_cap();
+        if (SegmentDemand(mv) + to.demand() > vehicle_cap)
+            return false;
+    }
+    return true;
+}
+
+void OrOptNeighborhoodExplorer::FillOrders(const RoutePlan &rp,
+                                           OrOptMove &mv) const {
+    const Route &from = rp[mv.old_route];
+    for (unsigned k = 0; k < mv.len && mv.old_pos + k < from.size(); ++k)
+        mv.orders[k] = from[mv.old_pos + k];
+}
+
+void OrOptNeighborhoodExplorer::AnyRandomMove(const RoutePlan &rp,
+                                              OrOptMove &mv) const {
+    mv.old_route = VRPRandom::Int(0, rp.size() - 1);
+    mv.old_pos = 0;
+    mv.len = 1;
+    unsigned old_size = rp[mv.old_route].size();
+    if (old_size) {
+        mv.old_pos = VRPRandom::Int(0, old_size - 1);
+        unsigned max_len = std::min(OrOptMove::kMaxLen, old_size - mv.old_pos);
+        mv.len = VRPRandom::Int(1, max_len);
+    }
+    FillOrders(rp, mv);
+    mv.new_route = VRPRandom::Int(0, rp.size() - 1);
+    int new_size = rp[mv.new_route].size();
+    if (mv.new_route == mv.old_route)
+        new_size -= mv.len;
+    mv.new_pos = new_size > 0 ? VRPRandom::Int(0, new_size) : 0;
+}
+
+void OrOptNeighborhoodExplorer::FirstMove(const RoutePlan &rp,
+                                          OrOptMove &mv) const {
+    mv.old_route = 0;
+    for (unsigned i = 0; i < rp.size(); ++i) {
+        if (rp[i].size()) {
+            mv.old_route = i;
+            break;
+        }
+    }
+    mv.old_pos = 0;
+    mv.len = 1;
+    FillOrders(rp, mv);
+    mv.new_route = 0;
+    mv.new_pos = 0;
+    if (!FeasibleMove(rp, mv))
+        NextMove(rp, mv);
+}
+
+bool OrOptNeighborhoodExplorer::NextMove(const RoutePlan &rp,
+                                         OrOptMove &mv) const {
+    bool not_last = true;
+    do {
+        not_last = AnyNextMove(rp, mv);
+    } while (!FeasibleMove(rp, mv) && not_last);
+    return not_last;
+}
+
+bool OrOptNeighborhoodExplorer::AnyNextMove(const RoutePlan &rp,
+                                            OrOptMove &mv) const {
+    const Route &from = rp[mv.old_route];
+    unsigned old_size = from.size();
+    int last_pos = rp[mv.new_route].size();
+    if (mv.new_route == mv.old_route)
+        last_pos -= mv.len;
+    if (static_cast<int>(mv.new_pos) < last_pos) {
+        mv.new_pos++;
+        return true;
+    } else if (mv.new_route < rp.size() - 1) {
+        mv.new_route++;
+        mv.new_pos = 0;
+        return true;
+    }
+    if (!from.IsExcList() && mv.len < OrOptMove::kMaxLen &&
+        mv.old_pos + mv.len < old_size) {
+        mv.len++;
+    } else if (old_size && mv.old_pos < old_size - 1) {
+        mv.old_pos++;
+        mv.len = 1;
+    } else if (mv.old_route < rp.size() - 1) {
+        mv.old_route++;
+        mv.old_pos = 0;
+        mv.len = 1;
+    } else {
+        return false;
+    }
+    mv.new_route = 0;
+    mv.new_pos = 0;
+    FillOrders(rp, mv);
+    return true;
+}
+
+void OrOptNeighborhoodExplorer::Pieces(const OrOptMove &mv,
+                                       unsigned old_size, unsigned new_size,
+                                       Piece p[2][4], unsigned n[2]) const {
+    unsigned o = mv.old_pos, e = mv.old_pos + mv.len, q = mv.new_pos;
+    if (mv.new_route == mv.old_route) {
+        // q counts the stops left once the segment is out
+        Piece back[4] = { { mv.old_route, 0, q },
+                          { mv.old_route, o, e },
+                          { mv.old_route, q, o },
+                          { mv.old_route, e, old_size } };
+        Piece ahead[4] = { { mv.old_route, 0, o },
+                           { mv.old_route, e, q + mv.len },
+                           { mv.old_route, o, e },
+                           { mv.old_route, q + mv.len, old_size } };
+        std::copy(back, back + 4, p[0]);
+        if (q > o)
+            std::copy(ahead, ahead + 4, p[0]);
+        n[0] = 4;
+        n[1] = 0;
+        return;
+    }
+    Piece from[2] = { { mv.old_route, 0, o },
+                      { mv.old_route, e, old_size } };
+    Piece to[3] = { { mv.new_route, 0, q },
+                    { mv.old_route, o, e },
+                    { mv.new_route, q, new_size } };
+    std::copy(from, from + 2, p[0]);
+    std::copy(to, to + 3, p[1]);
+    n[0] = 2;
+    n[1] = 3;
+}
+
+void
+OrOptNeighborhoodExplorer::MakeMove(RoutePlan &rp,
+                                    const OrOptMove &mv) const {
+    for (unsigned k = 0; k < mv.len; ++k)
+        rp[mv.old_route].erase(mv.old_pos);
+    for (unsigned k = 0; k < mv.len; ++k)
+        rp[mv.new_route].insert(mv.new_pos + k, mv.orders[k]);
+    // update timetable
+    if (!rp[mv.old_route].IsExcList())
+        UpdateRouteTimetable(rp.timetable(mv.old_route), rp[mv.old_route]);
+    if (mv.new_route != mv.old_route && !rp[mv.new_route].IsExcList())
+        UpdateRouteTimetable(rp.timetable(mv.new_route), rp[mv.new_route]);
+}
+
+int OrOptNeighborhoodExplorer::SegmentDemand(const OrOptMove &mv) const {
+    int demand = 0;
+    for (unsigned k = 0; k < mv.len; ++k)
+        demand += in.OrderGroupVect(mv.orders[k]).get_demand();
+    return demand;
+}
+
+int
+OrOptNeighborhoodExplorer::DeltaCostFunction(const RoutePlan &rp,
+                                             const OrOptMove &mv) const {
+    Piece p[2][4];
+    unsigned n[2];
+    Pieces(mv, rp[mv.old_route].size(), rp[mv.new_route].size(), p, n);
+    delta_cap = 0;
+    delta_num_order_late_return = 0;
+    int delta = DeltaDateViolationCost(rp, mv, 30)
+        + DeltaOptOrderCost(rp, mv, 250);
+    for (unsigned r = 0; r < 2; ++r) {
+        if (!n[r] || rp[p[r][0].route].IsExcList())
+            continue;
+        RouteCache::Delta d = cache_.Change(rp, p[r], n[r]);
+        delta += d.cost;
+        delta_num_order_late_return += d.late_return;
+        delta_cap += d.cap_excess;
+    }
+    delta_vio_ = RouteEvaluator::kCapWeight * delta_cap +
+        vio_wt * delta_num_order_late_return;
+    return delta + delta_vio_;
+}
+
+int
+OrOptNeighborhoodExplorer::DeltaObjective(const RoutePlan &rp,
+                                          const OrOptMove &mv) const {
+    int delta = DeltaCostFunction(rp, mv);
+    return delta - delta_vio_;
+}
+
+int
+OrOptNeighborhoodExplorer::DeltaViolations(const RoutePlan &rp,
+                                           const OrOptMove &mv) const {
+    DeltaCostFunction(rp, mv);
+    return delta_vio_;
+}
+
+int
+OrOptNeighborhoodExplorer::DeltaDateViolationCost(const RoutePlan &rp,
+                                        const OrOptMove &mv, int weight) const {
+    int delta = 0;
+    if (mv.new_route == mv.old_route)
+        return 0;
+    for (unsigned k = 0; k < mv.len; ++k)
+        delta += in.DatePenalty(mv.orders[k], mv.new_route)
+            - in.DatePenalty(mv.orders[k], mv.old_route);
+    return (weight * delta);
+}
+
+int
+OrOptNeighborhoodExplorer::DeltaOptOrderCost(const RoutePlan &rp,
+                                        const OrOptMove &mv, int weight) const {
+    int delta = 0;
+    if (mv.new_route == mv.old_route)
+        return 0;
+    for (unsigned k = 0; k < mv.len; ++k) {
+        const OrderGroup& o = in.OrderGroupVect(mv.orders[k]);
+        if (o.IsMandatory())
+            continue;
+        if (rp[mv.old_route].IsExcList())
+            delta -= o.get_demand();
+        else if (rp[mv.new_route].IsExcList())
+            delta += o.get_demand();
+    }
+    return (weight * delta);
+}
+
+// Ejection Chain Implementation
+
+void EjectionChainNeighborhoodExplorer::RandomMove(const RoutePlan &rp,
+                                                   EjectionChain &mv) const {
+    // a chain starts with a group that overfills a route
+    int max_demand = 0;
+    for (int og = 0; og < in.get_num_ogroup(); ++og)
+        max_demand = std::max(max_demand, in.OrderGroupVect(og).get_demand());
+    bool any = false;
+    for (unsigned r = 0; !any && r < rp.num_routes(); ++r)
+        any = rp[r].size() && static_cast<int>(rp[r].demand()) + max_demand >
+            static_cast<int>(in.VehicleVect(rp[r].get_vehicle()).get_cap());
+    if (!any)
+        throw EmptyNeighborhood("no route a group would overfill");
+    do {
+        mv.depth = 0;
+        mv.routes[0] = VRPRandom::Int(0, rp.size() - 1);
+        const Route &from = rp[mv.routes[0]];
+        if (!from.size())
+            continue;
+        mv.old_pos[0] = VRPRandom::Int(0, from.size() - 1);
+        mv.orders[0] = from[mv.old_pos[0]];
+        for (unsigned k = 0; k < EjectionChain::kMaxDepth; ++k) {
+            mv.depth = k + 1;
+            mv.routes[k + 1] = VRPRandom::Int(0, rp.num_routes() - 1);
+            const Route &to = rp[mv.routes[k + 1]];
+            // push a group out only where the incoming one does not fit
+            int cap = in.VehicleVect(to.get_vehicle()).get_cap();
+            int demand = in.OrderGroupVect(mv.orders[k]).get_demand();
+            bool push = k + 1 < EjectionChain::kMaxDepth && to.size() &&
+                static_cast<int>(to.demand()) + demand > cap;
+            if (push) {
+                mv.old_pos[k + 1] = VRPRandom::Int(0, to.size() - 1);
+                mv.orders[k + 1] = to[mv.old_pos[k + 1]];
+            }
+            mv.new_pos[k] = VRPRandom::Int(0, to.size() - (push ? 1 : 0));
+            if (!push)
+                break;
+        }
+    } while (!FeasibleMove(rp, mv));
+}
+
+bool EjectionChainNeighborhoodExplorer::FeasibleMove(const RoutePlan &rp,
+                                                     const EjectionChain &mv) const {
+    if (mv.depth < 2 || mv.depth > EjectionChain::kMaxDepth)
+        return false;
+    for (unsigned k = 0; k <= mv.depth; ++k) {
+        if (mv.routes[k] >= rp.size() ||
+            (k && rp[mv.routes[k]].IsExcList()) || InChain(mv, k, mv.routes[k]))
+            return false;
+    }
+    for (unsigned k = 0; k < mv.depth; ++k) {
+        const Route &from = rp[mv.routes[k]], &to = rp[mv.routes[k + 1]];
+        if (mv.old_pos[k] >= from.size() || from[mv.old_pos[k]] != static_cast<int>(mv.orders[k]))
+            return false;
+        if (!in.IsAdmissible(mv.orders[k], mv.routes[k + 1]))
+            return false;
+        // the next group, if any, leaves to before this one comes in
+        bool pushes = k + 1 < mv.depth;
+        if (pushes && (mv.old_pos[k + 1] >= to.size() ||
+                       to[mv.old_pos[k + 1]] != static_cast<int>(mv.orders[k + 1])))
+            return false;
+        if (mv.new_pos[k] > to.size() - (pushes ? 1 : 0))
+            return false;
+        int load = to.demand() + in.OrderGroupVect(mv.orders[k]).get_demand();
+        if (pushes)
+            load -= in.OrderGroupVect(mv.orders[k + 1]).get_demand();
+        if (load > static_cast<int>(in.VehicleVect(to.get_vehicle()).get_cap()))
+            return false;
+    }
+    return true;
+}
+
+bool EjectionChainNeighborhoodExplorer::InChain(const EjectionChain &mv,
+                                                unsigned k,
+                                                unsigned route) const {
+    for (unsigned j = 0; j < k; ++j)
+        if (mv.routes[j] == route)
+            return true;
+    return false;
+}
+
+void EjectionChainNeighborhoodExplorer::FirstMove(const RoutePlan &rp,
+                                                  EjectionChain &mv) const {
+    residual_.resize(rp.size());
+    for (unsigned r = 0; r < rp.size(); ++r)
+        residual_[r] = rp[r].IsExcList() ? 0 :
+            static_cast<int>(in.VehicleVect(rp[r].get_vehicle()).get_cap())
+            - static_cast<int>(rp[r].demand());
+    found_.clear();
+    found_hash_ = rp.hash();
+    for (unsigned r = 0; r < rp.size(); ++r) {
+        const Route &from = rp[r];
+        for (unsigned p = 0; p < from.size(); ++p) {
+            Found start = { EjectionChain(), 0, 0, 0 };
+            start.chain.depth = 0;
+            start.chain.routes[0] = r;
+            start.chain.orders[0] = from[p];
+            start.chain.old_pos[0] = p;
+            Add(start, Leave(rp, r, p), -GroupCost(rp, r, from[p]));
+            Extend(rp, start);
+        }
+    }
+    next_ = 0;
+    if (found_.empty()) {   // no move at all: an empty chain does nothing
+        mv.depth = 0;
+        mv.routes[0] = rp.size() - 1;
+        return;
+    }
+    mv = found_[0].chain;
+}
+
+bool EjectionChainNeighborhoodExplorer::NextMove(const RoutePlan &rp,
+                                                 EjectionChain &mv) const {
+    if (next_ + 1 >= found_.size())
+        return false;
+    mv = found_[++next_].chain;
+    return true;
+}
+
+void EjectionChainNeighborhoodExplorer::Extend(const RoutePlan &rp,
+                                               const Found &partial) const {
+    const EjectionChain &chain = partial.chain;
+    unsigned k = chain.depth;
+    int og = chain.orders[k];
+    int demand = in.OrderGroupVect(og).get_demand();
+    Piece src = { chain.routes[k], chain.old_pos[k], chain.old_pos[k] + 1 };
+    std::vector<Found> pushed;
+    std::vector<std::pair<int, unsigned> > by_delta;
+    for (unsigned t = 0; t < rp.num_routes(); ++t) {
+        if (InChain(chain, k + 1, t) || !in.IsAdmissible(og, t))
+            continue;
+        const Route &to = rp[t];
+        Found next(partial);
+        next.chain.depth = k + 1;
+        next.chain.routes[k + 1] = t;
+        if (demand <= residual_[t]) {
+            if (!k)     // a single link is an InsMove
+                continue;
+            const Place &place = BestPlace(rp, t, to.size(), src);
+            next.chain.new_pos[k] = place.pos;
+            Add(next, place.change, GroupCost(rp, t, og));
+            found_.push_back(next);
+            continue;
+        }
+        if (k + 1 == EjectionChain::kMaxDepth)
+            continue;
+        for (unsigned q = 0; q < to.size(); ++q) {
+            int out = to[q];
+            if (demand > residual_[t] + in.OrderGroupVect(out).get_demand())
+                continue;
+            const Place &place = BestPlace(rp, t, q, src);
+            Found pushing(next);
+            Add(pushing, place.change,
+                GroupCost(rp, t, og) - GroupCost(rp, t, out));
+            if (pushing.delta >= 0)
+                continue;
+            pushing.chain.new_pos[k] = place.pos;
+            pushing.chain.orders[k + 1] = out;
+            pushing.chain.old_pos[k + 1] = q;
+            by_delta.push_back(std::make_pair(pushing.delta, pushed.size()));
+            pushed.push_back(pushing);
+        }
+    }
+    std::sort(by_delta.begin(), by_delta.end());
+    for (unsigned i = 0; i < by_delta.size() && i < kWidth; ++i)
+        Extend(rp, pushed[by_delta[i].second]);
+}
+
+int EjectionChainNeighborhoodExplorer::GroupCost(const RoutePlan &rp,
+                                                 unsigned r, int og) const {
+    if (rp[r].IsExcList())
+        return eval.UnscheduledCost(og);
+    return RouteEvaluator::kDateWeight * in.DatePenalty(og, r);
+}
+
+void EjectionChainNeighborhoodExplorer::Add(Found &f,
+                                            const RouteCache::Delta &d,
+                                            int group_cost) const {
+    f.delta += d.cost + group_cost + RouteEvaluator::kCapWeight * d.cap_excess
+        + vio_wt * d.late_return;
+    f.late_return += d.late_return;
+    f.cap_excess += d.cap_excess;
+}
+
+RouteCache::Delta
+EjectionChainNeighborhoodExplorer::Leave(const RoutePlan &rp, unsigned r,
+                                         unsigned pos) const {
+    if (rp[r].IsExcList()) {
+        RouteCache::Delta none = { 0, 0, 0 };
+        return none;
+    }
+    Piece p[2] = { { r, 0, pos }, { r, pos + 1, rp[r].size() } };
+    return cache_.Change(rp, p, 2);
+}
+
+RouteCache::Delta
+EjectionChainNeighborhoodExplorer::Shift(const RoutePlan &rp, unsigned t,
+                                         unsigned ejected, unsigned pos,
+                                         const Piece &src) const {
+    unsigned n = rp[t].size();
+    if (ejected == n) {
+        Piece p[3] = { { t, 0, pos }, src, { t, pos, n } };
+        return cache_.Change(rp, p, 3);
+    }
+    if (pos <= ejected) {
+        Piece p[4] = { { t, 0, pos }, src, { t, pos, ejected },
+                       { t, ejected + 1, n } };
+        return cache_.Change(rp, p, 4);
+    }
+    Piece p[4] = { { t, 0, ejected }, { t, ejected + 1, pos + 1 }, src,
+                   { t, pos + 1, n } };
+    return cache_.Change(rp, p, 4);
+}
+
+const EjectionChainNeighborhoodExplorer::Place&
+EjectionChainNeighborhoodExplorer::BestPlace(const RoutePlan &rp, unsigned t,
+                                             unsigned ejected,
+                                             const Piece &src) const {
+    const Route &to = rp[t];
+    uint64_t og = rp[src.route][src.from];
+    uint64_t key = og << 42 | static_cast<uint64_t>(t) << 21 | ejected;
+    std::unordered_map<uint64_t, Place>::iterator it = place_.find(key);
+    if (it != place_.end() && it->second.hash == to.hash())
+        return it->second;
+    Place &best = place_[key];
+    best.hash = to.hash();
+    int best_cost = INT_MAX;
+    unsigned size = to.size() - (ejected < to.size() ? 1 : 0);
+    for (unsigned p = 0; p <= size; ++p) {
+        RouteCache::Delta d = Shift(rp, t, ejected, p, src);
+        int c = d.cost + RouteEvaluator::kCapWeight * d.cap_excess
+            + vio_wt * d.late_return;
+        if (c < best_cost) {
+            best.pos = p;
+            best.change = d;
+            best_cost = c;
+        }
+    }
+    return best;
+}
+
+EjectionChainNeighborhoodExplorer::Found
+EjectionChainNeighborhoodExplorer::Price(const RoutePlan &rp,
+                                         const EjectionChain &mv) const {
+    Found f = { mv, 0, 0, 0 };
+    Add(f, Leave(rp, mv.routes[0], mv.old_pos[0]),
+        -GroupCost(rp, mv.routes[0], mv.orders[0]));
+    for (unsigned k = 0; k < mv.depth; ++k) {
+        unsigned t = mv.routes[k + 1];
+        bool pushes = k + 1 < mv.depth;
+        Piece src = { mv.routes[k], mv.old_pos[k], mv.old_pos[k] + 1 };
+        int group_cost = GroupCost(rp, t, mv.orders[k]);
+        if (pushes)
+            group_cost -= GroupCost(rp, t, mv.orders[k + 1]);
+        Add(f, Shift(rp, t, pushes ? mv.old_pos[k + 1] : rp[t].size(),
+                     mv.new_pos[k], src), group_cost);
+    }
+    return f;
+}
+
+void EjectionChainNeighborhoodExplorer::MakeMove(RoutePlan &rp,
+                                                 const EjectionChain &mv) const {
+    if (!mv.depth)
+        return;
+    for (unsigned k = 0; k < mv.depth; ++k)
+        rp[mv.routes[k]].erase(mv.old_pos[k]);
+    for (unsigned k = 0; k < mv.depth; ++k)
+        rp[mv.routes[k + 1]].insert(mv.new_pos[k], mv.orders[k]);
+    for (unsigned k = 0; k <= mv.depth; ++k)
+        if (!rp[mv.routes[k]].IsExcList())
+            UpdateRouteTimetable(rp.timetable(mv.routes[k]), rp[mv.routes[k]]);
+}
+
+int
+EjectionChainNeighborhoodExplorer::DeltaCostFunction(const RoutePlan &rp,
+                                                     const EjectionChain &mv) const {
+    delta_num_order_late_return = 0;
+    delta_cap = 0;
+    delta_vio_ = 0;
+    if (!mv.depth)
+        return 0;
+    // the chain NextMove just gave, priced by the search
+    bool searched = next_ < found_.size() && found_[next_].chain == mv &&
+        rp.hash() == found_hash_;
+    Found f = searched ? found_[next_] : Price(rp, mv);
+    delta_num_order_late_return = f.late_return;
+    delta_cap = f.cap_excess;
+    delta_vio_ = RouteEvaluator::kCapWeight * delta_cap +
+        vio_wt * delta_num_order_late_return;
+    return f.delta;
+}
+
+int
+EjectionChainNeighborhoodExplorer::DeltaObjective(const RoutePlan &rp,
+                                                  const EjectionChain &mv) const {
+    int delta = DeltaCostFunction(rp, mv);
+    return delta - delta_vio_;
+}
+
+int
+EjectionChainNeighborhoodExplorer::DeltaViolations(const RoutePlan &rp,
+                                                   const EjectionChain &mv) const {
+    DeltaCostFunction(rp, mv);
+    return delta_vio_;
+}
+
+// Composite Neighborhood Implementation
+
+void CompositeNeighborhoodExplorer::RandomMove(const RoutePlan &rp,
+                                               CompositeMove &mv) const {
+    mv.kind = static_cast<CompositeMove::Kind>(VRPRandom::Int(0, 2));
+    if (mv.kind == CompositeMove::INS_MOVE)
+        ins_ne.RandomMove(rp, mv.ins);
+    else if (mv.kind == CompositeMove::INTER_SWAP)
+        inter_ne.RandomMove(rp, mv.inter);
+    else
+        intra_ne.RandomMove(rp, mv.intra);
+}
+
+bool CompositeNeighborhoodExplorer::FeasibleMove(const RoutePlan &rp,
+                                                 const CompositeMove &mv) const {
+    if (mv.kind == CompositeMove::INS_MOVE)
+        return ins_ne.FeasibleMove(rp, mv.ins);
+    if (mv.kind == CompositeMove::INTER_SWAP)
+        return inter_ne.FeasibleMove(rp, mv.inter);
+    return intra_ne.FeasibleMove(rp, mv.intra);
+}
+
+void CompositeNeighborhoodExplorer::MakeMove(RoutePlan &rp,
+                                             const CompositeMove &mv) const {
+    if (mv.kind == CompositeMove::INS_MOVE)
+        ins_ne.MakeMove(rp, mv.ins);
+    else if (mv.kind == CompositeMove::INTER_SWAP)
+        inter_ne.MakeMove(rp, mv.inter);
+    else
+        intra_ne.MakeMove(rp, mv.intra);
+}
+
+void CompositeNeighborhoodExplorer::FillOrders(const RoutePlan &rp,
+                                               CompositeMove &mv) const {
+    if (mv.kind == CompositeMove::INS_MOVE) {
+        mv.ins.order = rp[mv.ins.old_route][mv.ins.old_pos];
+    } else if (mv.kind == CompositeMove::INTER_SWAP) {
+        mv.inter.ord1 = rp[mv.inter.route1][mv.inter.pos1];
+        mv.inter.ord2 = rp[mv.inter.route2][mv.inter.pos2];
+    } else {
+        mv.intra.ord1 = rp[mv.intra.route][mv.intra.pos1];
+        mv.intra.ord2 = rp[mv.intra.route][mv.intra.pos2];
+    }
+}
+
+bool CompositeNeighborhoodExplorer::StartStage(const RoutePlan &rp,
+        CompositeMove &mv, int stage, unsigned a, unsigned b) const {
+    switch (stage) {
+        case 0:     // swaps inside route a
+            if (rp[a].IsExcList() || rp[a].size() < 2)
+                return false;
+            mv.kind = CompositeMove::INTRA_SWAP;
+            mv.intra.route = a;
+            mv.intra.pos1 = 0;
+            mv.intra.pos2 = 1;
+            break;
+        case 1:     // insertions from a into b
+        case 2:     // and from b into a
+            if (!rp[stage == 1 ? a : b].size())
+                return false;
+            mv.kind = CompositeMove::INS_MOVE;
+            mv.ins.old_route = stage == 1 ? a : b;
+            mv.ins.new_route = stage == 1 ? b : a;
+            mv.ins.old_pos = mv.ins.new_pos = 0;
+            break;
+        default:    // swaps between a and b
+            if (!rp[a].size() || !rp[b].size())
+                return false;
+            mv.kind = CompositeMove::INTER_SWAP;
+            mv.inter.route1 = a;
+            mv.inter.route2 = b;
+            mv.inter.pos1 = mv.inter.pos2 = 0;
+            break;
+    }
+    FillOrders(rp, mv);
+    return true;
+}
+
+bool CompositeNeighborhoodExplorer::AnyNextMove(const RoutePlan &rp,
+                                                CompositeMove &mv) const {
+    unsigned a, b;
+    int stage;
+    if (mv.kind == CompositeMove::INTRA_SWAP) {
+        unsigned route_size = rp[mv.intra.route].size();
+        a = b = mv.intra.route;
+        stage = 0;
+        // the placeholder of FirstMove may sit on a route of 0 or 1
+        if (mv.intra.pos2 + 1 < route_size) {
+            mv.intra.pos2++;
+            FillOrders(rp, mv);
+            return true;
+        } else if (mv.intra.pos1 + 2 < route_size) {
+            mv.intra.pos1++;
+            mv.intra.pos2 = mv.intra.pos1 + 1;
+            FillOrders(rp, mv);
+            return true;
+        }
+    } else if (mv.kind == CompositeMove::INS_MOVE) {
+        stage = mv.ins.old_route < mv.ins.new_route ? 1 : 2;
+        a = std::min(mv.ins.old_route, mv.ins.new_route);
+        b = std::max(mv.ins.old_route, mv.ins.new_route);
+        if (mv.ins.new_pos < rp[mv.ins.new_route].size()) {
+            mv.ins.new_pos++;
+            return true;
+        } else if (mv.ins.old_pos < rp[mv.ins.old_route].size() - 1) {
+            mv.ins.old_pos++;
+            mv.ins.new_pos = 0;
+            FillOrders(rp, mv);
+            return true;
+        }
+    } else {
+        stage = 3;
+        a = mv.inter.route1;
+        b = mv.inter.route2;
+        if (mv.inter.pos2 < rp[b].size() - 1) {
+            mv.inter.pos2++;
+            FillOrders(rp, mv);
+            return true;
+        } else if (mv.inter.pos1 < rp[a].size() - 1) {
+            mv.inter.pos1++;
+            mv.inter.pos2 = 0;
+            FillOrders(rp, mv);
+            return true;
+        }
+    }
+    // this stage is over: the next non-empty one, pair after pair
+    for (;;) {
+        if (a != b && stage < 3) {
+            ++stage;
+        } else if (b < rp.size() - 1) {
+            ++b;
+            stage = 1;
+        } else if (a < rp.size() - 1) {
+            b = ++a;
+            stage = 0;
+        } else {
+            return false;
+        }
+        if (StartStage(rp, mv, stage, a, b))
+            return true;
+    }
+}
+
+void CompositeNeighborhoodExplorer::FirstMove(const RoutePlan &rp,
+                                              CompositeMove &mv) const {
+    if (!StartStage(rp, mv, 0, 0, 0)) {
+        // a placeholder that AnyNextMove moves on from
+        mv.kind = CompositeMove::INTRA_SWAP;
+        mv.intra.route = 0;
+        mv.intra.pos1 = mv.intra.pos2 = rp[0].size();
+        if (!AnyNextMove(rp, mv))
+            return;
+    }
+    if (!FeasibleMove(rp, mv))
+        NextMove(rp, mv);
+}
+
+bool CompositeNeighborhoodExplorer::NextMove(const RoutePlan &rp,
+                                             CompositeMove &mv) const {
+    do {
+        if (!AnyNextMove(rp, mv))
+            return false;
+    } while (!FeasibleMove(rp, mv));
+    return true;
+}
+
+int CompositeNeighborhoodExplorer::GroupCost(const RoutePlan &rp,
+                                             unsigned r, int og) const {
+    if (rp[r].IsExcList())
+        return eval.UnscheduledCost(og);
+    return RouteEvaluator::kDateWeight * in.DatePenalty(og, r);
+}
+
+int CompositeNeighborhoodExplorer::Reprice(const RoutePlan &rp,
+                                           const Piece *p,
+                                           unsigned n) const {
+    if (rp[p[0].route].IsExcList())
+        return 0;
+    RouteCache::Delta d = cache_.Change(rp, p, n);
+    delta_num_order_late_return += d.late_return;
+    delta_cap += d.cap_excess;
+    return d.cost;
+}
+
+int
+CompositeNeighborhoodExplorer::DeltaCostFunction(const RoutePlan &rp,
+                                                 const CompositeMove &mv) const {
+    int delta = 0;
+    delta_num_order_late_return = 0;
+    delta_cap = 0;
+    if (mv.kind == CompositeMove::INS_MOVE) {
+        const InsMove &m = mv.ins;
+        unsigned o = m.old_pos, q = m.new_pos;
+        Piece from[2] = { { m.old_route, 0, o },
+                          { m.old_route, o + 1, rp[m.old_route].size() } };
+        Piece to[3] = { { m.new_route, 0, q },
+                        { m.old_route, o, o + 1 },
+                        { m.new_route, q, rp[m.new_route].size() } };
+        delta += Reprice(rp, from, 2) + Reprice(rp, to, 3);
+        delta += GroupCost(rp, m.new_route, m.order)
+            - GroupCost(rp, m.old_route, m.order);
+    } else if (mv.kind == CompositeMove::INTER_SWAP) {
+        const InterSwap &m = mv.inter;
+        unsigned i = m.pos1, j = m.pos2;
+        Piece r1[3] = { { m.route1, 0, i },
+                        { m.route2, j, j + 1 },
+                        { m.route1, i + 1, rp[m.route1].size() } };
+        Piece r2[3] = { { m.route2, 0, j },
+                        { m.route1, i, i + 1 },
+                        { m.route2, j + 1, rp[m.route2].size() } };
+        delta += Reprice(rp, r1, 3) + Reprice(rp, r2, 3);
+        delta += GroupCost(rp, m.route1, m.ord2)
+            - GroupCost(rp, m.route1, m.ord1)
+            + GroupCost(rp, m.route2, m.ord1)
+            - GroupCost(rp, m.route2, m.ord2);
+    } else {
+        const IntraSwap &m = mv.intra;
+        unsigned i = std::min(m.pos1, m.pos2), j = std::max(m.pos1, m.pos2);
+        Piece r[5] = { { m.route, 0, i },
+                       { m.route, j, j + 1 },
+                       { m.route, i + 1, j },
+                       { m.route, i, i + 1 },
+                       { m.route, j + 1, rp[m.route].size() } };
+        delta += Reprice(rp, r, 5);
+    }
+    delta_vio_ = RouteEvaluator::kCapWeight * delta_cap +
+        vio_wt * delta_num_order_late_return;
+    return delta + delta_vio_;
+}
+
+int
+CompositeNeighborhoodExplorer::DeltaObjective(const RoutePlan &rp,
+                                              const CompositeMove &mv) const {
+    int delta = DeltaCostFunction(rp, mv);
+    return delta - delta_vio_;
+}
+
+int
+CompositeNeighborhoodExplorer::DeltaViolations(const RoutePlan &rp,
+                                               const CompositeMove &mv) const {
+    DeltaCostFunction(rp, mv);
+    return delta_vio_;
+}
@@ -3,13 +3,26 @@
 #include <helpers/NeighborhoodExplorer.hh>
 #include <helpers/ProhibitionManager.hh>
 #include <fstream>
+#include <stdexcept>
 #include <vector>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include "data/neighbor.h"
 #include "data/route.h"
 #include "data/prob_input.h"
 #include "helpers/vrp_state_manager.h"
+#include "helpers/route_evaluator.h"
+#include "helpers/route_cache.h"
+#include "helpers/billing_cost_component.h"
+#include "helpers/vrp_random.h"
+
+// thrown by a RandomMove that has no move to draw from
+class EmptyNeighborhood: public std::logic_error {
+ public:
+    explicit EmptyNeighborhood(const std::string &what):
+        std::logic_error(what) { }
+};
 
 // #define _NE_DEBUG_H_
 // #define _VNE_DEBUG_H_
@@ -33,7 +46,8 @@ class TabuNeighborhoodExplorer:
 		protected:
 			TabuNeighborhoodExplorer(const ProbInput &in,
 					VRPStateManager &sm, std::string nm, int w):
-				NeighborhoodExplorer<ProbInput, RoutePlan, Move>(in, sm, nm), vio_wt(w) { }
+				NeighborhoodExplorer<ProbInput, RoutePlan, Move>(in, sm, nm), vio_wt(w),
+				eval(in, w) { }
 			void UpdateRouteTimetable(std::vector<int>&, const Route&) const;
 			int RouteCostsOnTimeWindow(const Route&, const std::vector<int>&, int*) const;
 			mutable std::vector<Route> routes_;
@@ -41,6 +55,7 @@ class TabuNeighborhoodExplorer:
 			mutable int delta_num_order_late_return;
 			mutable int delta_cap;
             int vio_wt;
+			RouteEvaluator eval;
 	};
 
 class InsMoveNeighborhoodExplorer: public TabuNeighborhoodExplorer<InsMove> {
@@ -148,95 +163,316 @@ class IntraSwapNeighborhoodExplorer:
 			// h2
 	};
 
+// 2-opt inside a route. Reversing a segment keeps the groups, the load
+// and the day of the route, so only the length and the time windows
+// change. The length comes from the two changed arcs and the length of
+// the segment run backwards; the time windows resume the walk stored
+// before the segment, and once past it stop as soon as the walk meets
+// the stored one again. BestMove stores the walks of a route once for
+// all its reversals; outside of it every move stores them anew.
+class TwoOptNeighborhoodExplorer: public TabuNeighborhoodExplorer<TwoOptMove> {
+	public:
+		TwoOptNeighborhoodExplorer(const ProbInput &in, VRPStateManager &sm, int w):
+			TabuNeighborhoodExplorer<TwoOptMove>(in, sm, "TwoOptNeighborhood", w),
+			scanning_(false), cached_(false), cached_route_(0),
+			delta_vio_(0) { }
+
+		// move generation
+		void RandomMove(const RoutePlan&, TwoOptMove&) const;
+		void FirstMove(const RoutePlan&, TwoOptMove&) const;
+		bool NextMove(const RoutePlan&, TwoOptMove&) const;
+		bool FeasibleMove(const RoutePlan&, const TwoOptMove&) const;
+		void MakeMove(RoutePlan&, const TwoOptMove&) const;
+		int BestMove(const RoutePlan&, TwoOptMove&,
+				ProhibitionManager<RoutePlan, TwoOptMove>&) const;
+
+		// delta cost
+		int DeltaCostFunction(const RoutePlan&, const TwoOptMove&) const;
+		int DeltaObjective(const RoutePlan&, const TwoOptMove &) const;
+		int DeltaViolations(const RoutePlan&, const TwoOptMove &) const;
+
+	private:
+		void AnyRandomMove(const RoutePlan&, TwoOptMove&) const;
+		bool AnyNextMove(const RoutePlan&, TwoOptMove&) const;
+		// walks and length prefixes of route r
+		void Prepare(const RoutePlan&, unsigned r) const;
+		mutable bool scanning_, cached_;
+		mutable unsigned cached_route_;
+		mutable std::vector<RouteEvaluator::Walk> walk_;  // after p stops
+		mutable std::vector<int> client_;
+		mutable std::vector<int> forward_, backward_;     // length to stop p
+		mutable int late_return_;   // orders, of the stored route
+		mutable int delta_vio_;
+};
+
+// CROSS exchange between two routes of a day, tail exchanges (2-opt*)
+// included. The day does not change, so neither do the date penalties;
+// both new routes are priced as pieces of the old ones from the route
+// cache, which keeps the prefixes of a route until its stops change.
+class CrossExchangeNeighborhoodExplorer:
+	public TabuNeighborhoodExplorer<CrossExchange> {
+		public:
+			CrossExchangeNeighborhoodExplorer(const ProbInput &in, VRPStateManager &sm, int w):
+				TabuNeighborhoodExplorer<CrossExchange>(in, sm, "CrossExchangeNeighborhood", w),
+				cache_(in, w), refused_route_(), refused_hash_(), delta_vio_(0) { }
+
+			// move generation
+			void RandomMove(const RoutePlan&, CrossExchange&) const;
+			void FirstMove(const RoutePlan&, CrossExchange&) const;
+			bool NextMove(const RoutePlan&, CrossExchange&) const;
+			bool FeasibleMove(const RoutePlan&, const CrossExchange&) const;
+			void MakeMove(RoutePlan&, const CrossExchange&) const;
+
+			// delta cost
+			int DeltaCostFunction(const RoutePlan&, const CrossExchange&) const;
+			int DeltaObjective(const RoutePlan&, const CrossExchange &) const;
+			int DeltaViolations(const RoutePlan&, const CrossExchange &) const;
+
+		private:
+			typedef RouteCache::Piece Piece;
+			void AnyRandomMove(const RoutePlan&, CrossExchange&) const;
+			bool AnyNextMove(const RoutePlan&, CrossExchange&) const;
+			// the segment lengths tried after len at pos: 1 to kMaxLen, then
+			// the tail; false after the tail
+			bool NextLen(unsigned &len, unsigned pos, unsigned size) const;
+			void FillOrders(const RoutePlan&, CrossExchange&) const;
+			// groups of the first p stops of from not admissible in to
+			int Refused(const RoutePlan&, unsigned from, unsigned to,
+					unsigned p) const;
+			// delta of route p[0].route becoming the three pieces
+			int DeltaRoute(const RoutePlan&, const Piece*) const;
+			// the pieces of the new route1 and of the new route2
+			void Pieces(const RoutePlan&, const CrossExchange&, Piece *p1,
+					Piece *p2) const;
+			mutable RouteCache cache_;
+			mutable std::vector<int> refused_[2];
+			mutable unsigned refused_route_[2][2];
+			mutable uint64_t refused_hash_[2];
+			mutable int delta_vio_;
+	};
+
+// Whole routes trading vehicle and day. The timetable of a route does not
+// depend on either, so only the bills, the fixed costs, the date
+// penalties and the capacity change; all come from a summary of each
+// route (its bill profile, date penalty on every day, vehicles fitting
+// all of its groups), and a move costs nothing per order. BestMove
+// summarises every route once.
+class RouteSwapNeighborhoodExplorer: public TabuNeighborhoodExplorer<RouteSwap> {
+	public:
+		RouteSwapNeighborhoodExplorer(const ProbInput &in, VRPStateManager &sm, int w):
+			TabuNeighborhoodExplorer<RouteSwap>(in, sm, "RouteSwapNeighborhood", w),
+			scanning_(false), delta_vio_(0) { }
+
+		// move generation
+		void RandomMove(const RoutePlan&, RouteSwap&) const;
+		void FirstMove(const RoutePlan&, RouteSwap&) const;
+		bool NextMove(const RoutePlan&, RouteSwap&) const;
+		bool FeasibleMove(const RoutePlan&, const RouteSwap&) const;
+		void MakeMove(RoutePlan&, const RouteSwap&) const;
+		int BestMove(const RoutePlan&, RouteSwap&,
+				ProhibitionManager<RoutePlan, RouteSwap>&) const;
+
+		// delta cost
+		int DeltaCostFunction(const RoutePlan&, const RouteSwap&) const;
+		int DeltaObjective(const RoutePlan&, const RouteSwap &) const;
+		int DeltaViolations(const RoutePlan&, const RouteSwap &) const;
+
+	private:
+		struct Summary {
+			Summary(const ProbInput &in, const Route &r);
+			unsigned size;
+			RouteProfile profile;
+			std::vector<int> date;          // penalty of the groups on each day
+			std::vector<uint64_t> fits;     // vehicles taking every group
+		};
+		bool AnyNextMove(const RoutePlan&, RouteSwap&) const;
+		// the summaries of the two routes, stored ones in BestMove
+		void Summaries(const RoutePlan&, const RouteSwap&,
+				const Summary **s1, const Summary **s2) const;
+		// cost of contents s in route r; *cap_excess gets its overload
+		int CostIn(const Summary &s, const Route &r, int *cap_excess) const;
+		mutable bool scanning_;
+		mutable std::vector<Summary> summary_;
+		mutable std::vector<Summary> local_;
+		mutable int delta_vio_;
+};
+
+// Or-opt: segments of up to OrOptMove::kMaxLen consecutive groups move
+// to another place of their route or of another one. The date and
+// optional terms come from the segment alone; the changed routes are
+// priced as pieces of the old ones from the route cache, so a move costs
+// the arcs at its joins and the part of the walk it changes.
+class OrOptNeighborhoodExplorer: public TabuNeighborhoodExplorer<OrOptMove> {
+	public:
+		OrOptNeighborhoodExplorer(const ProbInput &in, VRPStateManager &sm, int w):
+			TabuNeighborhoodExplorer<OrOptMove>(in, sm, "OrOptNeighborhood", w),
+			cache_(in, w), delta_vio_(0) { }
+
+		// move generation
+		void RandomMove(const RoutePlan&, OrOptMove&) const;
+		void FirstMove(const RoutePlan&, OrOptMove&) const;
+		bool NextMove(const RoutePlan&, OrOptMove&) const;
+		bool FeasibleMove(const RoutePlan&, const OrOptMove&) const;
+		void MakeMove(RoutePlan&, const OrOptMove&) const;
+
+		// delta cost
+		int DeltaCostFunction(const RoutePlan&, const OrOptMove&) const;
+		int DeltaObjective(const RoutePlan&, const OrOptMove &) const;
+		int DeltaViolations(const RoutePlan&, const OrOptMove &) const;
+
+	private:
+		typedef RouteCache::Piece Piece;
+		void AnyRandomMove(const RoutePlan&, OrOptMove&) const;
+		bool AnyNextMove(const RoutePlan&, OrOptMove&) const;
+		void FillOrders(const RoutePlan&, OrOptMove&) const;
+		// the new old_route in p[0] and, if the segment leaves it, the new
+		// new_route in p[1]; n[r] pieces each
+		void Pieces(const OrOptMove&, unsigned old_size, unsigned new_size,
+				Piece p[2][4], unsigned n[2]) const;
+		int SegmentDemand(const OrOptMove&) const;
+		int DeltaDateViolationCost(const RoutePlan&,
+				const OrOptMove&, int) const;     // s1
+		int DeltaOptOrderCost(const RoutePlan&,
+				const OrOptMove&, int) const;          // s3
+		mutable RouteCache cache_;
+		mutable int delta_vio_;
+};
+
+// Ejection chains for tight fleets: a group that does not fit its
+// target route pushes one of the target's groups on to a third route,
+// and so on for up to EjectionChain::kMaxDepth links, at least two: a
+// single link is an InsMove. FirstMove searches the chains depth first
+// from every group, over the residual capacity of each route; every
+// group takes its cheapest place in its new route, priced from the route
+// cache and kept while that route stays the same, and a partial chain is
+// extended, kWidth best first, only while it saves cost. NextMove walks
+// the chains found, and DeltaCostFunction takes their cost from the
+// search.
+class EjectionChainNeighborhoodExplorer:
+	public TabuNeighborhoodExplorer<EjectionChain> {
+		public:
+			EjectionChainNeighborhoodExplorer(const ProbInput &in,
+					VRPStateManager &sm, int w):
+				TabuNeighborhoodExplorer<EjectionChain>(in, sm, "EjectionChainNeighborhood", w),
+				cache_(in, w), found_hash_(0), next_(0), delta_vio_(0) { }
+
+			// move generation
+			void RandomMove(const RoutePlan&, EjectionChain&) const;
+			void FirstMove(const RoutePlan&, EjectionChain&) const;
+			bool NextMove(const RoutePlan&, EjectionChain&) const;
+			bool FeasibleMove(const RoutePlan&, const EjectionChain&) const;
+			void MakeMove(RoutePlan&, const EjectionChain&) const;
+
+			// delta cost
+			int DeltaCostFunction(const RoutePlan&, const EjectionChain&) const;
+			int DeltaObjective(const RoutePlan&, const EjectionChain&) const;
+			int DeltaViolations(const RoutePlan&, const EjectionChain&) const;
+
+		private:
+			static const unsigned kWidth = 3;
+			typedef RouteCache::Piece Piece;
+			// a chain, maybe partial, and what it changes the cost by
+			struct Found {
+				EjectionChain chain;
+				int delta;          // violations included
+				int late_return;
+				int cap_excess;
+			};
+			// cheapest place of a group in a route that may eject a stop
+			struct Place {
+				uint64_t hash;      // of the route when priced
+				unsigned pos;
+				RouteCache::Delta change;
+			};
+			int GroupCost(const RoutePlan&, unsigned r, int og) const;
+			void Add(Found&, const RouteCache::Delta&, int group_cost) const;
+			// route r losing its stop pos
+			RouteCache::Delta Leave(const RoutePlan&, unsigned r,
+					unsigned pos) const;
+			// route t losing stop ejected, none if it is t's size, and
+			// taking the group of stop src.from of src.route at pos
+			RouteCache::Delta Shift(const RoutePlan&, unsigned t,
+					unsigned ejected, unsigned pos, const Piece &src) const;
+			const Place& BestPlace(const RoutePlan&, unsigned t,
+					unsigned ejected, const Piece &src) const;
+			Found Price(const RoutePlan&, const EjectionChain&) const;
+			// places the last group of the partial chain, recording the
+			// closed chains in found_
+			void Extend(const RoutePlan&, const Found &partial) const;
+			bool InChain(const EjectionChain&, unsigned k, unsigned route) const;
+			mutable RouteCache cache_;
+			mutable std::unordered_map<uint64_t, Place> place_;
+			mutable std::vector<int> residual_;
+			mutable std::vector<Found> found_;
+			mutable uint64_t found_hash_;   // of the plan searched
+			mutable unsigned next_;
+			mutable int delta_vio_;
+	};
+
+// Union of the three neighborhoods, enumerated one route pair at a time:
+// the swaps inside a route, then between two routes the insertions both
+// ways and the swaps. A move prices the one or two routes it changes as
+// pieces of the old ones from the route cache, plus the date and
+// unscheduled costs of the groups it moves; generation, feasibility and
+// MakeMove are left to the explorer of the move's kind.
+class CompositeNeighborhoodExplorer:
+	public TabuNeighborhoodExplorer<CompositeMove> {
+		public:
+			CompositeNeighborhoodExplorer(const ProbInput &in, VRPStateManager &sm,
+					InsMoveNeighborhoodExplorer &ins,
+					InterSwapNeighborhoodExplorer &inter,
+					IntraSwapNeighborhoodExplorer &intra, int w):
+				TabuNeighborhoodExplorer<CompositeMove>(in, sm, "CompositeNeighborhood", w),
+				ins_ne(ins), inter_ne(inter), intra_ne(intra), cache_(in, w),
+				delta_vio_(0) { }
+
+			// move generation
+			void RandomMove(const RoutePlan&, CompositeMove&) const;
+			void FirstMove(const RoutePlan&, CompositeMove&) const;
+			bool NextMove(const RoutePlan&, CompositeMove&) const;
+			bool FeasibleMove(const RoutePlan&, const CompositeMove&) const;
+			void MakeMove(RoutePlan&, const CompositeMove&) const;
+
+			// delta cost
+			int DeltaCostFunction(const RoutePlan&, const CompositeMove&) const;
+			int DeltaObjective(const RoutePlan&, const CompositeMove&) const;
+			int DeltaViolations(const RoutePlan&, const CompositeMove&) const;
+
+		private:
+			typedef RouteCache::Piece Piece;
+			// what group og costs in route r besides the route's own terms:
+			// its date penalty, or its cost as unscheduled
+			int GroupCost(const RoutePlan&, unsigned r, int og) const;
+			// adds the change of route p[0].route becoming the n pieces,
+			// nothing for the unscheduled list
+			int Reprice(const RoutePlan&, const Piece *p, unsigned n) const;
+			// positions the move on the first candidate of stage (see
+			// AnyNextMove) of the route pair a <= b; false if it has none
+			bool StartStage(const RoutePlan&, CompositeMove&, int stage,
+					unsigned a, unsigned b) const;
+			bool AnyNextMove(const RoutePlan&, CompositeMove&) const;
+			void FillOrders(const RoutePlan&, CompositeMove&) const;
+			InsMoveNeighborhoodExplorer &ins_ne;
+			InterSwapNeighborhoodExplorer &inter_ne;
+			IntraSwapNeighborhoodExplorer &intra_ne;
+			mutable RouteCache cache_;
+			mutable int delta_vio_;
+	};
+
 // Implementation
 
 template <class Move>
 void
 TabuNeighborhoodExplorer<Move>::UpdateRouteTimetable(std::vector<int> &ret,
 		const Route &r) const {
-	int arrive_time = this->in.get_depart_time();
-	int stop_time = this->in.get_depart_time();
-	std::string client_from(this->in.get_depot());
-	unsigned route_size = r.size();
-	ret.clear();
-	for (unsigned i = 0; i <= route_size; ++i) {
-		std::string client_to(this->in.get_depot());
-		if (i < route_size)
-			client_to = this->in.OrderGroupVect(r[i]).get_client();
-		if (client_from != client_to) {
-			int ready_time = this->in.FindClient(client_to).get_ready_time();
-			arrive_time += this->in.FindClient(client_from).get_service_time()
-				+ this->in.get_time_dist(client_from, client_to);
-
-			if (arrive_time - stop_time > 45 * 360) {    // driving rests
-				arrive_time += 45 * 60;
-				if (arrive_time < ready_time)
-					arrive_time = ready_time;
-				stop_time = arrive_time;
-			} else if (arrive_time < ready_time) {
-				if (ready_time - arrive_time >= 45 * 60)
-					stop_time = ready_time;
-				arrive_time = ready_time;
-			}
-		}
-		ret.push_back(arrive_time);
-		client_from = client_to;
-	}
-	return;
+	eval.Timetable(r, ret);
 }
 
 template <class Move> int
 TabuNeighborhoodExplorer<Move>::RouteCostsOnTimeWindow(const Route &r,
 		const std::vector<int> &time,
 		int *late_return) const {
-	bool over_time = false;
-	int cost = 0, day = -1, final_day = 86399;
-	int prev_arrive_time = this->in.get_depart_time();
-	*late_return = 0;
-	for (unsigned i = 0; i <= r.size(); ++i) {
-		int og_size = 1, duetime = this->in.get_return_time();
-		if (i < r.size()) {
-			const OrderGroup &og = this->in.OrderGroupVect(r[i]);
-			duetime = this->in.FindClient(og.get_client()).get_due_time();
-			og_size = og.size();
-		}
-		int tt = time[i];  // get arrive time of order j on route i
-		if (tt < prev_arrive_time) {
-			over_time = true;
-			day++;
-		}
-		if (tt > duetime || over_time) {
-			if (over_time) {    // arrive time past current day
-				tt += final_day - duetime + day * 86400;
-				cost += tt * og_size;
-				if (i == r.size())
-					*late_return += r.size();
-			} else {
-				cost += (tt - duetime) * og_size;
-				// later 1 hour
-				if (i == r.size() && tt - duetime > 3600)
-					*late_return += r.size();
-			}
-		}
-		prev_arrive_time = tt;
-	}
-	return cost;
-	// for (unsigned i = pos; i < r.size(); ++i) {
-	//     std::string client = this->in.OrderGroupVect(r[i]).get_client();
-	//     int duetime = this->in.FindClient(client).get_due_time();
-	//     int arrive_time = rp(r, i);
-	//     if (arrive_time > duetime)
-	//         delta -= arrive_time - duetime;
-	// }
-
-	// // after move
-	// for (unsigned i = pos; i < routes_[isnew].size(); ++i) {
-	//     const OrderGroup &og = in.OrderGroupVect(routes_[isnew][i]);
-	//     int duetime = this->in.FindClient(og.get_client()).get_due_time();
-	//     if (timetable_[isnew][i] > duetime)
-	//         delta += timetable_[isnew][i] - duetime;
-	// }
-	// return delta;
+	return eval.TimeWindowCost(r, time, late_return);
 }
 
 template <class Move>
@@ -254,8 +490,6 @@ int TabuNeighborhoodExplorer<Move>::BestMove(const RoutePlan &st, Move &mv,
     bool all_moves_prohibited = pm.ProhibitedMove(st, mv, mv_cost);
     bool all_moves_violated = best_vio > 0 ? true : false;
 
-    static unsigned int i1 = 0, i2 = 0;
-
     while (NextMove(st, mv) && !this->ExternalTerminationRequest()) {
         mv_cost = DeltaCostFunction(st, mv);
         int mv_vio = get_delta_cap() + get_delta_late_return();
@@ -303,14 +537,14 @@ int TabuNeighborhoodExplorer<Move>::BestMove(const RoutePlan &st, Move &mv,
                     all_moves_prohibited = false;
                 } else {
                     // accept the move with probability 1 / (1 + number_of_bests)
-                    if (Random::Int(0,number_of_bests) == 0) {
+                    if (VRPRandom::Int(0,number_of_bests) == 0) {
                         best_move = mv;
                         best_vio = mv_vio;
                     }
                     number_of_bests++;
                 }
             } else if (all_moves_prohibited) {
-                if (Random::Int(0,number_of_bests) == 0) {
+                if (VRPRandom::Int(0,number_of_bests) == 0) {
                     // accept the move with probability 1 / (1 + number_of_bests)
                     best_move = mv;
                     best_vio = mv_vio;
@@ -326,10 +560,6 @@ int TabuNeighborhoodExplorer<Move>::BestMove(const RoutePlan &st, Move &mv,
         }
     }
 
-    if (all_moves_prohibited)
-        i1++;
-    i2++;
-    //std::cerr << (float)i1/i2 << ' ' << best_move << " ";
     mv = best_move;
     st.set_vio(st.get_vio() + best_vio);
     return best_delta;
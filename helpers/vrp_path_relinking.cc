@@ -0,0 +1,83 @@
+#include "helpers/vrp_path_relinking.h"
+#include <climits>
+#include <vector>
+
+PathRelinking::PathRelinking(const ProbInput &in,
+                             VRPStateManager &e_sm,
+                             InsMoveNeighborhoodExplorer &ins,
+                             ElitePool &p,
+                             std::string name):
+    Runner<ProbInput, RoutePlan>(in, e_sm, name, "Path relinking"),
+    ins_ne(ins), pool(p), remaining(0), current_move_cost(0) { }
+
+void PathRelinking::ReadParameters(std::istream &is, std::ostream &os) {
+    os << "PATH RELINKING -- INPUT PARAMETERS" << std::endl;
+    os << "  Max iterations: ";
+    is >> this->max_iteration;
+}
+
+void PathRelinking::Print(std::ostream &os) const {
+    os << "Path Relinking: " << this->name << std::endl;
+    os << "  Max iterations: " << this->max_iteration << std::endl;
+    os << "  Elite plans: " << pool.size() << std::endl;
+}
+
+void PathRelinking::InitializeRun() {
+    Runner<ProbInput, RoutePlan>::InitializeRun();
+    this->best_state = this->current_state;
+    this->best_state_cost = this->current_state_cost;
+    this->iteration_of_best = this->number_of_iterations;
+    guide_route_of.clear();
+    remaining = 0;
+    int guide = pool.PickGuide(this->current_state);
+    if (guide < 0)
+        return;
+    guide_route_of = pool.route_of(guide);
+    std::vector<int> route_of;
+    this->current_state.RouteOf(route_of);
+    remaining = ElitePool::Distance(route_of, guide_route_of);
+}
+
+bool PathRelinking::StopCriterion() {
+    return !remaining;
+}
+
+void PathRelinking::SelectMove() {
+    const RoutePlan &rp = this->current_state;
+    InsMove mv;
+    current_move_cost = INT_MAX;
+    for (unsigned r = 0; r < rp.size(); ++r) {
+        for (unsigned p = 0; p < rp[r].size(); ++p) {
+            mv.order = rp[r][p];
+            mv.old_route = r;
+            mv.old_pos = p;
+            mv.new_route = guide_route_of[mv.order];
+            if (mv.new_route == r)
+                continue;
+            // the unscheduled list is not in any order
+            const Route &to = rp[mv.new_route];
+            unsigned last = to.IsExcList() ? 0 : to.size();
+            for (mv.new_pos = 0; mv.new_pos <= last; ++mv.new_pos) {
+                int delta = ins_ne.DeltaCostFunction(rp, mv);
+                if (delta < current_move_cost) {
+                    current_move = mv;
+                    current_move_cost = delta;
+                }
+            }
+        }
+    }
+}
+
+void PathRelinking::MakeMove() {
+    ins_ne.MakeMove(this->current_state, current_move);
+    this->current_state_cost += current_move_cost;
+    --remaining;
+}
+
+void PathRelinking::StoreMove() {
+    if (this->current_state_cost < this->best_state_cost) {
+        this->best_state = this->current_state;
+        this->best_state_cost = this->current_state_cost;
+        this->iteration_of_best = this->number_of_iterations;
+    }
+}
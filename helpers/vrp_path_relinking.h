@@ -0,0 +1,48 @@
+#ifndef _VRP_PATH_RELINKING_H_
+#define _VRP_PATH_RELINKING_H_
+#include <runners/Runner.hh>
+#include <utils/CLParser.hh>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "data/route.h"
+#include "data/prob_input.h"
+#include "data/neighbor.h"
+#include "helpers/vrp_state_manager.h"
+#include "helpers/vrp_neighborhood_explorer.h"
+#include "helpers/elite_pool.h"
+
+// Path relinking from the current plan towards a random member of the
+// elite pool. Every step moves one order group into its route in the
+// guide, the cheapest such InsMove by its delta at the cheapest place,
+// capacity or not, until the two plans assign every group alike; the
+// best plan on the way is the result. With no other plan in the pool
+// the runner does nothing.
+class PathRelinking: public Runner<ProbInput, RoutePlan> {
+ public:
+    PathRelinking(const ProbInput &in,
+                  VRPStateManager &e_sm,
+                  InsMoveNeighborhoodExplorer &ins,
+                  ElitePool &pool,
+                  std::string name);
+    ~PathRelinking() { }
+    void ReadParameters(std::istream &is = std::cin,
+                        std::ostream &os = std::cout);
+    void Print(std::ostream &os = std::cout) const;
+ protected:
+    void InitializeRun();
+    bool StopCriterion();
+    void SelectMove();
+    bool AcceptableMove() { return true; }
+    void MakeMove();
+    void StoreMove();
+ private:
+    InsMoveNeighborhoodExplorer &ins_ne;
+    ElitePool &pool;
+    std::vector<int> guide_route_of;   // empty without a guide
+    unsigned remaining;                 // groups still out of their route
+    InsMove current_move;
+    int current_move_cost;
+};
+
+#endif
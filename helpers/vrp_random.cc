@@ -0,0 +1,38 @@
+#include "helpers/vrp_random.h"
+#include <atomic>
+#include <random>
+
+namespace {
+
+std::atomic<unsigned long> base_seed(5489u);
+std::atomic<unsigned long> threads_seeded(0);
+
+std::mt19937& Engine() {
+    thread_local std::mt19937 engine(base_seed + threads_seeded++);
+    return engine;
+}
+
+}  // namespace
+
+void VRPRandom::Seed(unsigned long seed) {
+    base_seed = seed;
+    threads_seeded = 0;
+    SeedThread(seed);
+}
+
+void VRPRandom::SeedThread(unsigned long seed) {
+    Engine().seed(seed);
+}
+
+int VRPRandom::Int(int lo, int hi) {
+    return std::uniform_int_distribution<int>(lo, hi)(Engine());
+}
+
+double VRPRandom::Double(double lo, double hi) {
+    return std::uniform_real_distribution<double>(lo, hi)(Engine());
+}
+
+std::mutex& VRPRandom::LibraryLock() {
+    static std::mutex lock;
+    return lock;
+}
@@ -0,0 +1,25 @@
+#ifndef _VRP_RANDOM_H_
+#define _VRP_RANDOM_H_
+#include <mutex>
+
+// Uniform draws from a generator of the calling thread's own. EasyLocal's
+// Random is one unsynchronized generator for the whole process, so the
+// runners, explorers and solvers draw from here instead and any number of
+// threads may search at once. A thread that is not seeded explicitly gets
+// the base seed plus the number of threads seeded before it.
+class VRPRandom {
+ public:
+    // seeds the calling thread and is the base for threads seeded later
+    static void Seed(unsigned long seed);
+    // seeds the calling thread only, as a worker does before it starts
+    static void SeedThread(unsigned long seed);
+    // in [lo, hi]
+    static int Int(int lo, int hi);
+    // in [lo, hi)
+    static double Double(double lo, double hi);
+    // held around the draws left inside EasyLocal, which still go to its
+    // shared generator
+    static std::mutex& LibraryLock();
+};
+
+#endif
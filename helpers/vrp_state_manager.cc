@@ -1,5 +1,5 @@
 #include "helpers/vrp_state_manager.h"
-#include <utils/Random.hh>
+#include "helpers/vrp_random.h"
 #include <fstream>
 #include <vector>
 #include <string>
@@ -12,6 +12,14 @@
 
 void VRPStateManager::RandomState(RoutePlan &rp) {
 	ResetState(rp);
+	if (init_mode != RANDOM_INIT) {
+		if (init_mode == REGRET_INIT)
+			regret.Construct(rp);
+		else
+			savings.Construct(rp);
+		UpdateTimeTable(rp);
+		return;
+	}
     // bool man_first = true;
     // int i = 0, num_og_visited = 0, num_og = in.get_num_ogroup();
     // std::vector<bool> og_table(num_og, false);
@@ -28,7 +36,7 @@ void VRPStateManager::RandomState(RoutePlan &rp) {
     //     num_og_visited++;
 	// 	std::pair<int, int> date_window = o.get_dw();
 	// 	assert(date_window.first >= 1);
-	// 	int day = Random::Int(date_window.first - 1, date_window.second - 1);
+	// 	int day = VRPRandom::Int(date_window.first - 1, date_window.second - 1);
 	// 	assert(o.IsDayFeasible(day));
 
 	// 	std::vector<int> rvec(0);
@@ -42,7 +50,7 @@ void VRPStateManager::RandomState(RoutePlan &rp) {
     //         }
     //     }
     //     if (rvec.size()) {
-    //         int idx = Random::Int(0, rvec.size() - 1);
+    //         int idx = VRPRandom::Int(0, rvec.size() - 1);
     //         rp.AddOrder(i, day, rvec[idx], false);
     //     } else {
     //         assert(!o.IsMandatory());
@@ -55,13 +63,15 @@ void VRPStateManager::RandomState(RoutePlan &rp) {
 		const OrderGroup &o = in.OrderGroupVect(i);
 		std::pair<int, int> date_window = o.get_dw();
 		assert(date_window.first >= 1);
-		int day = Random::Int(date_window.first - 1, date_window.second - 1);
+		int day = VRPRandom::Int(date_window.first - 1, date_window.second - 1);
 		assert(o.IsDayFeasible(day));
 
 		std::vector<int> rvec(0);
 		std::vector<int> qvec(0);
-        for (int k = 0; k < in.get_num_vehicle(); ++k) {
-            if (in.IsReachable(k, i)) {
+        const uint64_t *admissible = in.FittingVehicles(i);
+        for (int w = 0; w < in.get_vehicle_words(); ++w) {
+            for (uint64_t bits = admissible[w]; bits; bits &= bits - 1) {
+                int k = w * 64 + LowestBit(bits);
                 int cap = in.VehicleVect(k).get_cap();
                 int route_index = day * in.get_num_vehicle() + k;
                 int delta = cap - rp[route_index].demand() - o.get_demand();
@@ -85,7 +95,7 @@ void VRPStateManager::RandomState(RoutePlan &rp) {
                     idx = k;
                 }
             }
-            // int idx = Random::Int(0, rvec.size() - 1);
+            // int idx = VRPRandom::Int(0, rvec.size() - 1);
             rp.AddOrder(i, day, rvec[idx], false);
         } else {
             assert(!o.IsMandatory());
@@ -110,38 +120,8 @@ int VRPStateManager::SampleState(RoutePlan &rp, unsigned t) {
 }
 
 void VRPStateManager::UpdateTimeTable(RoutePlan &rp) {
-	for (unsigned i = 0; i < rp.num_routes(); ++i) {
-		std::string client_from(in.get_depot());
-		int arrive_time = in.get_depart_time();
-		int stop_time = in.get_depart_time();
-		int route_size = rp[i].size();
-
-		rp.ResizeRouteTimetable(i, route_size + 1, 0);
-
-		for (int j = 0; j <= route_size; ++j) {
-			std::string client_to(in.get_depot());
-			if (j < route_size)
-				client_to = in.OrderGroupVect(rp[i][j]).get_client();
-			if (client_from != client_to) {
-				int ready_time = in.FindClient(client_to).get_ready_time();
-				arrive_time += in.FindClient(client_from).get_service_time()
-					+ in.get_time_dist(client_from, client_to);
-				if (arrive_time - stop_time > 45 * 360) {    // driving rests
-					arrive_time += 45 * 60;
-					if (arrive_time < ready_time)
-						arrive_time = ready_time;
-					stop_time = arrive_time;
-				} else if (arrive_time < ready_time) {
-					if (ready_time - arrive_time >= 45 * 60)
-						stop_time = ready_time;
-					arrive_time = ready_time;
-				}
-			}
-			rp(i, j) = arrive_time;
-			// timetable[i][j] = arrive_time;
-			client_from = client_to;
-		}
-	}
+	for (unsigned i = 0; i < rp.num_routes(); ++i)
+		eval.Timetable(rp[i], rp.timetable(i));
 }
 
 int VRPStateManager::CostFunction(const RoutePlan &rp) const {
@@ -165,9 +145,9 @@ int VRPStateManager::Objective(const RoutePlan &rp) const {
 		<< std::endl;
 	return dw_cost + tw_cost + opt_cost + trans_cost;
 #else
-	int obj = ComputeDateViolationCost(rp, 30) +
-		ComputeTimeViolationCost(rp, 10) +
-		ComputeOptOrderCost(rp, 250) +
+	int obj = ComputeDateViolationCost(rp, RouteEvaluator::kDateWeight) +
+		ComputeTimeViolationCost(rp, RouteEvaluator::kTimeWeight) +
+		ComputeOptOrderCost(rp, RouteEvaluator::kOptionalWeight) +
 		ComputeTranportationCost(rp);
 	return obj;
 #endif
@@ -181,7 +161,8 @@ int VRPStateManager::Violations(const RoutePlan &rp) const {
 		<< late_cost << std::endl;
 	return cap_cost + late_cost;
 #else
-	return ComputeCapExceededCost(rp, 1) + ComputeLateReturnCost(rp, vio_wt);
+	return ComputeCapExceededCost(rp, RouteEvaluator::kCapWeight) +
+		ComputeLateReturnCost(rp, vio_wt);
 #endif
 }
 
@@ -190,11 +171,8 @@ VRPStateManager::ComputeDateViolationCost(const RoutePlan& rp,
 		int weight) const {
 	int cost = 0;
 	for (unsigned i = 0; i < rp.num_routes(); ++i) {
-		for (unsigned k = 0; k < rp[i].size(); ++k) {
-			const OrderGroup &og = in.OrderGroupVect(rp[i][k]);
-			int day = rp[i].get_day();
-			cost += (1 - og.IsDayFeasible(day)) * og.get_demand();
-		}
+		for (unsigned k = 0; k < rp[i].size(); ++k)
+			cost += in.DatePenalty(rp[i][k], i);
 	}
 	return (weight * cost);
 }
@@ -202,38 +180,11 @@ VRPStateManager::ComputeDateViolationCost(const RoutePlan& rp,
 int
 VRPStateManager::ComputeTimeViolationCost(const RoutePlan &rp,
 		int weight) const {
-	int cost = 0, final_day = 86399;
+	int cost = 0;
 	for (unsigned i = 0; i < rp.num_routes(); ++i) {
-		bool over_time = false;
-		int day = -1, prev_arrive_time = in.get_depart_time();
-		for (unsigned j = 0; j <= rp[i].size(); ++j) {
-			int og_size = 1, duetime = in.get_return_time();
-			if (j < rp[i].size()) {
-				const OrderGroup &og = in.OrderGroupVect(rp[i][j]);
-				duetime = in.FindClient(og.get_client()).get_due_time();
-				og_size = og.size();
-			}
-			int tt = rp(i, j);  // get arrive time of order j on route i
-			if (tt < prev_arrive_time) {
-				over_time = true;
-				day++;
-			}
-			if (tt > duetime || over_time) {
-				if (over_time) {    // arrive time past current day
-					tt += final_day - duetime + day * 86400;
-					cost += tt * og_size;
-					if (j == rp[i].size())
-						num_order_late_return += rp[i].size();
-				} else {
-					cost += (tt - duetime) * og_size;
-					// later 1 hour
-					if (j == rp[i].size() && tt - duetime > 3600)
-						num_order_late_return += rp[i].size();
-				}
-			}
-			prev_arrive_time = tt;
-		}
-		// std::cout << "Route " << i << ": " << cost - old_cost << std::endl;
+		int late_return;
+		cost += eval.TimeWindowCost(rp[i], rp.timetable(i), &late_return);
+		num_order_late_return += late_return;
 	}
 	return (weight * cost);
 }
@@ -251,18 +202,8 @@ VRPStateManager::ComputeOptOrderCost(const RoutePlan &rp, int weight) const {
 int
 VRPStateManager::ComputeTranportationCost(const RoutePlan &rp) const {
 	int cost = 0;
-	for (unsigned i = 0; i < rp.num_routes(); ++i) {
-		const Billing *cr = in.FindBilling(rp[i].get_vehicle());
-		int route_var_cost = cr->GetCostComponent().Cost(rp[i]);
-		cost += route_var_cost;
-		// cost += cr->GetCostComponent().Cost(rp[i]);
-		if (rp[i].size())   // add vehcile fixed cost
-			cost += in.VehicleVect(rp[i].get_vehicle()).fixed_cost();
-// #ifdef _STATE_DEBUG_H_
-// 		std::cout << "Route " << i << ", " << "var cost: " << route_var_cost
-// 			<< std::endl;
-// #endif
-	}
+	for (unsigned i = 0; i < rp.num_routes(); ++i)
+		cost += eval.TransportationCost(rp[i]);
 	return cost;
 }
 
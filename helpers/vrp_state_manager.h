@@ -6,18 +6,27 @@
 #include <vector>
 #include "data/route.h"
 #include "data/prob_input.h"
+#include "helpers/route_evaluator.h"
+#include "helpers/regret_insertion.h"
+#include "helpers/savings_construction.h"
 
 // #define _STATE_DEBUG_H_
 #define _INIT_H_
 
 class VRPStateManager: public StateManager<ProbInput, RoutePlan> {
  public:
+    // how RandomState, and so SampleState, builds a plan
+    enum InitMode { RANDOM_INIT, REGRET_INIT, SAVINGS_INIT };
     explicit VRPStateManager(const ProbInput &pi, int w):
         StateManager<ProbInput, RoutePlan>(pi, "VRPStateManager"),
-        num_order_late_return(0), cap_vio_cost(0), vio_wt(w) { }
+        num_order_late_return(0), cap_vio_cost(0), vio_wt(w), eval(pi, w),
+        regret(pi, eval), savings(pi, eval), init_mode(RANDOM_INIT) { }
     ~VRPStateManager() { }
     void UpdateTimeTable(RoutePlan&);
     void RandomState(RoutePlan&);
+    void set_init_mode(InitMode m) { init_mode = m; }
+    void set_regret_k(int k) { regret.set_k(k); }
+    const RouteEvaluator& get_evaluator() const { return eval; }
     int SampleState(RoutePlan&, unsigned);
     bool CheckConsistency(const RoutePlan&) const { return true; }
     int CostFunction(const RoutePlan&) const;
@@ -38,6 +47,10 @@ class VRPStateManager: public StateManager<ProbInput, RoutePlan> {
     mutable int num_order_late_return;
     mutable int cap_vio_cost;
     int vio_wt;
+    RouteEvaluator eval;
+    RegretInsertion regret;
+    SavingsConstruction savings;
+    InitMode init_mode;
 };
 
 #endif
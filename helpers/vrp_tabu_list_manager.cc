@@ -47,3 +47,74 @@ bool IntraSwapTabuListManager::Inverse(const IntraSwap &mt,
         return true;
     return false;
 }
+
+bool TwoOptTabuListManager::Inverse(const TwoOptMove &mt,
+                                    const TwoOptMove &me) const {
+    if (me.ord1 == mt.ord1 || me.ord2 == mt.ord2 ||
+        me.ord1 == mt.ord2 || me.ord2 == mt.ord1)
+        return true;
+    return false;
+}
+
+bool CrossExchangeTabuListManager::Inverse(const CrossExchange &mt,
+                                           const CrossExchange &me) const {
+    if (me.route1 != mt.route1 || me.route2 != mt.route2)
+        return false;
+    return (me.ord1 >= 0 && (me.ord1 == mt.ord1 || me.ord1 == mt.ord2)) ||
+        (me.ord2 >= 0 && (me.ord2 == mt.ord1 || me.ord2 == mt.ord2));
+}
+
+bool RouteSwapTabuListManager::Inverse(const RouteSwap &mt,
+                                       const RouteSwap &me) const {
+    return me.route1 == mt.route1 && me.route2 == mt.route2;
+}
+
+bool EjectionChainTabuListManager::Inverse(const EjectionChain &mt,
+                                           const EjectionChain &me) const {
+    for (unsigned i = 0; i < me.depth; ++i)
+        for (unsigned j = 0; j < mt.depth; ++j)
+            if (me.orders[i] == mt.orders[j])
+                return true;
+    return false;
+}
+
+bool OrOptTabuListManager::Inverse(const OrOptMove &mt,
+                                   const OrOptMove &me) const {
+    for (unsigned i = 0; i < me.len; ++i)
+        for (unsigned j = 0; j < mt.len; ++j)
+            if (me.orders[i] == mt.orders[j])
+                return true;
+    return false;
+}
+
+namespace {
+
+// the order groups a move relocates; unused slots repeat the first
+void MovedOrders(const CompositeMove &mv, unsigned ords[2]) {
+    if (mv.kind == CompositeMove::INS_MOVE) {
+        ords[0] = ords[1] = mv.ins.order;
+    } else if (mv.kind == CompositeMove::INTER_SWAP) {
+        ords[0] = mv.inter.ord1;
+        ords[1] = mv.inter.ord2;
+    } else {
+        ords[0] = mv.intra.ord1;
+        ords[1] = mv.intra.ord2;
+    }
+}
+
+}  // namespace
+
+bool CompositeTabuListManager::Inverse(const CompositeMove &mt,
+                                       const CompositeMove &me) const {
+    if (mt.kind == me.kind) {
+        if (me.kind == CompositeMove::INS_MOVE)
+            return ins_tlm.Inverse(mt.ins, me.ins);
+        if (me.kind == CompositeMove::INTER_SWAP)
+            return inter_tlm.Inverse(mt.inter, me.inter);
+        return intra_tlm.Inverse(mt.intra, me.intra);
+    }
+    unsigned t[2], e[2];
+    MovedOrders(mt, t);
+    MovedOrders(me, e);
+    return e[0] == t[0] || e[0] == t[1] || e[1] == t[0] || e[1] == t[1];
+}
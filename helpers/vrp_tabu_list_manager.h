@@ -2,35 +2,108 @@
 #define _VRP_TABU_LIST_MANAGER_H_
 
 #include <helpers/TabuListManager.hh>
+#include <mutex>
 #include "data/route.h"
 #include "data/neighbor.h"
+#include "helpers/vrp_random.h"
 
-class InsMoveTabuListManager: public TabuListManager<RoutePlan, InsMove> {
+// EasyLocal draws each tenure from its shared generator, so runners on
+// different threads take turns at inserting their moves.
+template <class Move>
+class VRPTabuListManager: public TabuListManager<RoutePlan, Move> {
+ public:
+    void InsertMove(const RoutePlan &rp, const Move &mv, const int &mv_cost,
+                    const int &curr, const int &best) {
+        std::lock_guard<std::mutex> lock(VRPRandom::LibraryLock());
+        TabuListManager<RoutePlan, Move>::InsertMove(rp, mv, mv_cost, curr,
+                                                     best);
+    }
+ protected:
+    VRPTabuListManager(): TabuListManager<RoutePlan, Move>() { }
+};
+
+class InsMoveTabuListManager: public VRPTabuListManager<InsMove> {
  public:
     InsMoveTabuListManager(unsigned i):
-        TabuListManager<RoutePlan, InsMove>(), index(i) { }
+        VRPTabuListManager<InsMove>(), index(i) { }
     bool Inverse(const InsMove&, const InsMove&) const;
  protected:
     unsigned index;
     // bool ListMember(const InsMove&) const;
 };
 
-class InterSwapTabuListManager: public TabuListManager<RoutePlan, InterSwap> {
+class InterSwapTabuListManager: public VRPTabuListManager<InterSwap> {
  public:
     InterSwapTabuListManager():
-        TabuListManager<RoutePlan, InterSwap>() { }
+        VRPTabuListManager<InterSwap>() { }
     bool Inverse(const InterSwap&, const InterSwap&) const;
  protected:
     // bool ListMember(const InsMove&) const;
 };
 
-class IntraSwapTabuListManager: public TabuListManager<RoutePlan, IntraSwap> {
+class IntraSwapTabuListManager: public VRPTabuListManager<IntraSwap> {
  public:
     IntraSwapTabuListManager():
-        TabuListManager<RoutePlan, IntraSwap>() { }
+        VRPTabuListManager<IntraSwap>() { }
     bool Inverse(const IntraSwap&, const IntraSwap&) const;
  protected:
     // bool ListMember(const InsMove&) const;
 };
 
+class TwoOptTabuListManager: public VRPTabuListManager<TwoOptMove> {
+ public:
+    TwoOptTabuListManager():
+        VRPTabuListManager<TwoOptMove>() { }
+    bool Inverse(const TwoOptMove&, const TwoOptMove&) const;
+};
+
+// An exchange is tabu while a recent one cut the same two routes at a
+// common group.
+class CrossExchangeTabuListManager:
+    public VRPTabuListManager<CrossExchange> {
+ public:
+    CrossExchangeTabuListManager():
+        VRPTabuListManager<CrossExchange>() { }
+    bool Inverse(const CrossExchange&, const CrossExchange&) const;
+};
+
+// Swapping a pair of routes back is tabu.
+class RouteSwapTabuListManager: public VRPTabuListManager<RouteSwap> {
+ public:
+    RouteSwapTabuListManager():
+        VRPTabuListManager<RouteSwap>() { }
+    bool Inverse(const RouteSwap&, const RouteSwap&) const;
+};
+
+// A chain is tabu while it moves an order group of a recent one.
+class EjectionChainTabuListManager:
+    public VRPTabuListManager<EjectionChain> {
+ public:
+    EjectionChainTabuListManager():
+        VRPTabuListManager<EjectionChain>() { }
+    bool Inverse(const EjectionChain&, const EjectionChain&) const;
+};
+
+// A segment is tabu while it shares an order group with a recent one.
+class OrOptTabuListManager: public VRPTabuListManager<OrOptMove> {
+ public:
+    OrOptTabuListManager():
+        VRPTabuListManager<OrOptMove>() { }
+    bool Inverse(const OrOptMove&, const OrOptMove&) const;
+};
+
+// Moves of one kind are compared as their own managers would; moves of
+// different kinds are inverse when they touch a common order group.
+class CompositeTabuListManager:
+    public VRPTabuListManager<CompositeMove> {
+ public:
+    CompositeTabuListManager(unsigned i):
+        VRPTabuListManager<CompositeMove>(), ins_tlm(i) { }
+    bool Inverse(const CompositeMove&, const CompositeMove&) const;
+ protected:
+    InsMoveTabuListManager ins_tlm;
+    InterSwapTabuListManager inter_tlm;
+    IntraSwapTabuListManager intra_tlm;
+};
+
 #endif
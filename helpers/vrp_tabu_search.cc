@@ -0,0 +1,18 @@
+#include "helpers/vrp_tabu_search.h"
+
+template <>
+void VRPTabuSearch<InsMove>::LogMove() {
+    log << this->current_state << std::endl
+        << this->current_move << std::endl
+        << this->current_move_cost << std::endl;
+}
+
+template <>
+void VRPTabuSearch<InterSwap>::LogMove() {
+    this->pm.Print(log);    // for debug, print tabu list
+}
+
+template <>
+void VRPTabuSearch<IntraSwap>::LogMove() {
+    this->pm.Print(log);    // for debug, print tabu list
+}
@@ -9,91 +9,77 @@
 #include "helpers/vrp_state_manager.h"
 #include "helpers/vrp_neighborhood_explorer.h"
 #include "helpers/vrp_tabu_list_manager.h"
+#include "helpers/solution_memory.h"
+#include "helpers/route_pool.h"
 
-class InsMoveTabuSearch:
-public TabuSearch<ProbInput, RoutePlan, InsMove> {
+// The tabu runner of every neighborhood: the plans of the run are
+// remembered by hash, and a run that keeps coming back to them is
+// cycling, its tabu list too short to break away; it then ends its turn
+// after max_revisits revisits so that another runner moves the plan on.
+// With a route pool attached, the routes of every plan of the run are
+// offered to it. A plan without violations is always preferred as best
+// to one with; among plans alike, one of the same cost replaces the
+// best for diversification. With a log, every stored move is written
+// out by LogMove.
+template <class Move>
+class VRPTabuSearch: public TabuSearch<ProbInput, RoutePlan, Move> {
  public:
-    InsMoveTabuSearch(const ProbInput &in,
-                      VRPStateManager &e_sm,
-                      InsMoveNeighborhoodExplorer &e_ne,
-                      InsMoveTabuListManager &tlm,
-                      std::string name, 
-                      CLParser& cl,
-                      AbstractTester<ProbInput, RoutePlan> &t,
-                      bool flag,
-                      std::ostream &log_os = std::cout):
-        TabuSearch<ProbInput, RoutePlan, InsMove>(in, e_sm, e_ne,
-                                                  tlm, name, cl, t),
-        have_log(flag), log(log_os) { }
-    ~InsMoveTabuSearch() { }
+    VRPTabuSearch(const ProbInput &in,
+                  VRPStateManager &e_sm,
+                  NeighborhoodExplorer<ProbInput, RoutePlan, Move> &e_ne,
+                  TabuListManager<RoutePlan, Move> &tlm,
+                  std::string name,
+                  CLParser& cl,
+                  AbstractTester<ProbInput, RoutePlan> &t,
+                  bool flag,
+                  std::ostream &log_os = std::cout):
+        TabuSearch<ProbInput, RoutePlan, Move>(in, e_sm, e_ne,
+                                               tlm, name, cl, t),
+        max_revisits(20), route_pool(0), have_log(flag), log(log_os) { }
+    void set_max_revisits(unsigned n) { max_revisits = n; }
+    unsigned revisits() const { return memory.revisits(); }
+    void AttachRoutePool(RoutePool &pool) { route_pool = &pool; }
+ protected:
+    void InitializeRun() {
+        TabuSearch<ProbInput, RoutePlan, Move>::InitializeRun();
+        memory.Clear();
+        memory.Visit(this->current_state);
+    }
+    bool StopCriterion() {
+        return TabuSearch<ProbInput, RoutePlan, Move>::StopCriterion() ||
+            memory.revisits() >= max_revisits;
+    }
     void StoreMove();
- private:
+    // the move and its cost, unless specialized below
+    void LogMove();
+    SolutionMemory memory;
+    unsigned max_revisits;
+    RoutePool *route_pool;
     bool have_log;
     std::ostream &log;
 };
 
-class InterSwapTabuSearch:
-public TabuSearch<ProbInput, RoutePlan, InterSwap> {
- public:
-    InterSwapTabuSearch(const ProbInput &in,
-                        VRPStateManager &e_sm,
-                        InterSwapNeighborhoodExplorer &e_ne,
-                        InterSwapTabuListManager &tlm,
-                        std::string name, 
-                        CLParser& cl,
-                        AbstractTester<ProbInput, RoutePlan> &t,
-					    bool flag,
-                        std::ostream &log_os = std::cout):
-        TabuSearch<ProbInput, RoutePlan, InterSwap>(in, e_sm, e_ne,
-                                                  tlm, name, cl, t),
-        have_log(flag), log(log_os) { }
-    ~InterSwapTabuSearch() { }
-    void StoreMove();
- private:
-	bool have_log;
-    std::ostream &log;
-};
-
-class IntraSwapTabuSearch:
-public TabuSearch<ProbInput, RoutePlan, IntraSwap> {
- public:
-    IntraSwapTabuSearch(const ProbInput &in,
-                        VRPStateManager &e_sm,
-                        IntraSwapNeighborhoodExplorer &e_ne,
-                        IntraSwapTabuListManager &tlm,
-                        std::string name, 
-                        CLParser& cl,
-                        AbstractTester<ProbInput, RoutePlan> &t,
-                        bool flag,
-                        std::ostream &log_os = std::cout):
-        TabuSearch<ProbInput, RoutePlan, IntraSwap>(in, e_sm, e_ne,
-                                                  tlm, name, cl, t),
-        have_log(flag), log(log_os) { }
-    ~IntraSwapTabuSearch() { }
-    void StoreMove();
- private:
-	bool have_log;
-    std::ostream &log;
-};
-
-void InsMoveTabuSearch::StoreMove() {
+template <class Move>
+void VRPTabuSearch<Move>::StoreMove() {
     if (have_log) {
         log << "--" << std::endl;
-        log << this->current_state << std::endl
-            << this->current_move << std::endl
-            << this->current_move_cost << std::endl;
+        LogMove();
         log << "--" << std::endl;
     }
     if (this->observer != NULL)
         this->observer->NotifyStoreMove(*this);
-    this->pm.InsertMove(this->current_state, this->current_move, this->current_move_cost,
-                        this->current_state_cost, this->best_state_cost);
-    bool cur_vio = this->current_state.get_vio() > 0 ? true : false;
-    bool best_vio = this->best_state.get_vio() > 0 ? true: false;
-    if (!(cur_vio ^ best_vio)) {
-        if (LessOrEqualThan(this->current_state_cost,this->best_state_cost)) {
+    this->pm.InsertMove(this->current_state, this->current_move,
+                        this->current_move_cost, this->current_state_cost,
+                        this->best_state_cost);
+    memory.Visit(this->current_state);
+    if (route_pool != NULL)
+        route_pool->Harvest(this->current_state);
+    bool cur_vio = this->current_state.get_vio() > 0;
+    bool best_vio = this->best_state.get_vio() > 0;
+    if (cur_vio == best_vio) {
+        if (LessOrEqualThan(this->current_state_cost, this->best_state_cost)) {
             // same cost states are accepted as best for diversification
-            if (LessThan(this->current_state_cost,this->best_state_cost)) {
+            if (LessThan(this->current_state_cost, this->best_state_cost)) {
                 if (this->observer != NULL)
                     this->observer->NotifyNewBest(*this);
                 this->iteration_of_best = this->number_of_iterations;
@@ -101,80 +87,34 @@ void InsMoveTabuSearch::StoreMove() {
             }
             this->best_state = this->current_state;
         }
-    } else if (!cur_vio && best_vio) {
+    } else if (!cur_vio) {
         if (this->observer != NULL)
             this->observer->NotifyNewBest(*this);
         this->iteration_of_best = this->number_of_iterations;
         this->best_state_cost = this->current_state_cost;
         this->best_state = this->current_state;
     }
-    // TabuSearch<ProbInput, RoutePlan, InterSwap>::StoreMove();
 }
 
-void InterSwapTabuSearch::StoreMove() {
-	if (have_log) {
-		log << "--" << std::endl;
-		this->pm.Print(log);    // for debug, print tabu list
-		log << "--" << std::endl;
-	}
-    if (this->observer != NULL)
-        this->observer->NotifyStoreMove(*this);
-    this->pm.InsertMove(this->current_state, this->current_move, this->current_move_cost,
-                        this->current_state_cost, this->best_state_cost);
-    bool cur_vio = this->current_state.get_vio() > 0 ? true : false;
-    bool best_vio = this->best_state.get_vio() > 0 ? true: false;
-    if (!(cur_vio ^ best_vio)) {
-        if (LessOrEqualThan(this->current_state_cost,this->best_state_cost)) {
-            // same cost states are accepted as best for diversification
-            if (LessThan(this->current_state_cost,this->best_state_cost)) {
-                if (this->observer != NULL)
-                    this->observer->NotifyNewBest(*this);
-                this->iteration_of_best = this->number_of_iterations;
-                this->best_state_cost = this->current_state_cost;
-            }
-            this->best_state = this->current_state;
-        }
-    } else if (!cur_vio && best_vio) {
-        if (this->observer != NULL)
-            this->observer->NotifyNewBest(*this);
-        this->iteration_of_best = this->number_of_iterations;
-        this->best_state_cost = this->current_state_cost;
-        this->best_state = this->current_state;
-    }
-    // TabuSearch<ProbInput, RoutePlan, InterSwap>::StoreMove();
+template <class Move>
+void VRPTabuSearch<Move>::LogMove() {
+    log << this->current_move << std::endl
+        << this->current_move_cost << std::endl;
 }
 
-void IntraSwapTabuSearch::StoreMove() {
-	if (have_log) {
-		log << "--" << std::endl;
-		this->pm.Print(log);    // for debug, print tabu list
-		log << "--" << std::endl;
-	}
-    if (this->observer != NULL)
-        this->observer->NotifyStoreMove(*this);
-    this->pm.InsertMove(this->current_state, this->current_move, this->current_move_cost,
-                        this->current_state_cost, this->best_state_cost);
-    bool cur_vio = this->current_state.get_vio() > 0 ? true : false;
-    bool best_vio = this->best_state.get_vio() > 0 ? true: false;
-    if (!(cur_vio ^ best_vio)) {
-        if (LessOrEqualThan(this->current_state_cost,this->best_state_cost)) {
-            // same cost states are accepted as best for diversification
-            if (LessThan(this->current_state_cost,this->best_state_cost)) {
-                if (this->observer != NULL)
-                    this->observer->NotifyNewBest(*this);
-                this->iteration_of_best = this->number_of_iterations;
-                this->best_state_cost = this->current_state_cost;
-            }
-            this->best_state = this->current_state;
-        }
-    } else if (!cur_vio && best_vio) {
-        if (this->observer != NULL)
-            this->observer->NotifyNewBest(*this);
-        this->iteration_of_best = this->number_of_iterations;
-        this->best_state_cost = this->current_state_cost;
-        this->best_state = this->current_state;
-    }
-    // TabuSearch<ProbInput, RoutePlan, InterSwap>::StoreMove();
-}
+// the insertion runner logs the plan too, the swap ones their tabu list
+template <> void VRPTabuSearch<InsMove>::LogMove();
+template <> void VRPTabuSearch<InterSwap>::LogMove();
+template <> void VRPTabuSearch<IntraSwap>::LogMove();
+
+typedef VRPTabuSearch<InsMove> InsMoveTabuSearch;
+typedef VRPTabuSearch<InterSwap> InterSwapTabuSearch;
+typedef VRPTabuSearch<IntraSwap> IntraSwapTabuSearch;
+typedef VRPTabuSearch<CompositeMove> CompositeTabuSearch;
+typedef VRPTabuSearch<OrOptMove> OrOptTabuSearch;
+typedef VRPTabuSearch<TwoOptMove> TwoOptTabuSearch;
+typedef VRPTabuSearch<CrossExchange> CrossExchangeTabuSearch;
+typedef VRPTabuSearch<RouteSwap> RouteSwapTabuSearch;
+typedef VRPTabuSearch<EjectionChain> EjectionChainTabuSearch;
 
 #endif
@@ -6,11 +6,15 @@
 #include <testers/Tester.hh>
 #include <utils/CLParser.hh>
 #include <utils/Random.hh>
+#include <sys/stat.h>
 #include <cstdlib>
 #include <fstream>
+#include <memory>
+#include <stdexcept>
 #include <sstream>
 #include <string>
 #include "data/prob_input.h"
+#include "data/mapped_file.h"
 #include "data/neighbor.h"
 #include "data/route.h"
 #include "helpers/vrp_state_manager.h"
@@ -18,40 +22,142 @@
 #include "helpers/vrp_tabu_list_manager.h"
 #include "helpers/vrp_output_manager.h"
 #include "helpers/vrp_tabu_search.h"
+#include "helpers/vrp_lns.h"
+#include "helpers/vrp_annealing.h"
+#include "helpers/elite_pool.h"
+#include "helpers/vrp_path_relinking.h"
+#include "helpers/route_pool.h"
+#include "helpers/vrp_random.h"
 #include "solvers/vrp_token_ring_search.h"
 #include "solvers/vrp_token_ring_observer.h"
+#include "solvers/vrp_genetic_search.h"
+#include "solvers/vrp_decomposition_search.h"
 #define RANDOM_MAX 0xffffffffUL
 
 int main(int argc, char *argv[]) {
     CLParser cl(argc, argv);
     ValArgument<std::string> arg_input_file("file", "f", true, cl);
-    ValArgument<int> arg_index("index", "i", true, cl);
-    ValArgument<int> arg_cycle("cycle", "c", true, cl);
-    ValArgument<int> arg_weight("weight", "w", true, cl);
+    ValArgument<int> arg_index("index", "i", false, cl);
+    ValArgument<int> arg_cycle("cycle", "c", false, cl);
+    ValArgument<int> arg_weight("weight", "w", false, cl);
+    FlagArgument arg_compile("compile", "cp", false);
+    FlagArgument arg_shared("shared", "shm", false);
+    FlagArgument arg_lns("lns", "lns", false);
+    FlagArgument arg_sa("annealing", "sa", false);
+    FlagArgument arg_la("late_acceptance", "la", false);
+    FlagArgument arg_composite("composite", "cmp", false);
+    FlagArgument arg_or_opt("or_opt", "oo", false);
+    FlagArgument arg_two_opt("two_opt", "to", false);
+    FlagArgument arg_cross("cross_exchange", "cx", false);
+    FlagArgument arg_route_swap("route_swap", "rs", false);
+    FlagArgument arg_ejection("ejection_chain", "ec", false);
+    FlagArgument arg_relink("path_relinking", "pr", false);
+    FlagArgument arg_genetic("genetic", "ga", false);
+    FlagArgument arg_decomposition("day_decomposition", "dd", false);
+    FlagArgument arg_route_pool("route_pool", "rp", false);
+    ValArgument<std::string> arg_init("init", "init", false, cl);
+    cl.AddArgument(arg_compile);
+    cl.AddArgument(arg_shared);
+    cl.AddArgument(arg_lns);
+    cl.AddArgument(arg_sa);
+    cl.AddArgument(arg_la);
+    cl.AddArgument(arg_composite);
+    cl.AddArgument(arg_or_opt);
+    cl.AddArgument(arg_two_opt);
+    cl.AddArgument(arg_cross);
+    cl.AddArgument(arg_route_swap);
+    cl.AddArgument(arg_ejection);
+    cl.AddArgument(arg_relink);
+    cl.AddArgument(arg_genetic);
+    cl.AddArgument(arg_decomposition);
+    cl.AddArgument(arg_route_pool);
     cl.MatchArgument(arg_input_file);
     cl.MatchArgument(arg_index);
     cl.MatchArgument(arg_cycle);
     cl.MatchArgument(arg_weight);
+    cl.MatchArgument(arg_compile);
+    cl.MatchArgument(arg_shared);
+    cl.MatchArgument(arg_lns);
+    cl.MatchArgument(arg_sa);
+    cl.MatchArgument(arg_la);
+    cl.MatchArgument(arg_composite);
+    cl.MatchArgument(arg_or_opt);
+    cl.MatchArgument(arg_two_opt);
+    cl.MatchArgument(arg_cross);
+    cl.MatchArgument(arg_route_swap);
+    cl.MatchArgument(arg_ejection);
+    cl.MatchArgument(arg_relink);
+    cl.MatchArgument(arg_genetic);
+    cl.MatchArgument(arg_decomposition);
+    cl.MatchArgument(arg_route_pool);
+    cl.MatchArgument(arg_init);
 
     std::string test_dir = "./test-cases/";
     std::string test_file = test_dir + arg_input_file.GetValue() + ".vrp";
-    std::cout << test_file << std::endl;
-    std::ifstream f(test_file.c_str());
-    if (!f.is_open()) {
-        std::cout << "No input case file." << std::endl;
-        return 0;
+    std::string compiled_file = test_file + "b";
+    // prefer the compiled instance unless the text file is newer
+    struct stat text_st, compiled_st;
+    bool use_compiled = !arg_compile.IsSet() &&
+        stat(compiled_file.c_str(), &compiled_st) == 0 &&
+        (stat(test_file.c_str(), &text_st) != 0 ||
+         compiled_st.st_mtime >= text_st.st_mtime);
+    std::cout << (use_compiled ? compiled_file : test_file) << std::endl;
+    // concurrent runs of one case can share a single copy of the instance
+    std::string segment = "/vrptw-" + arg_input_file.GetValue();
+    std::unique_ptr<ProbInput> p_in;
+    try {
+        if (arg_shared.IsSet())
+            p_in.reset(new ProbInput(use_compiled ? compiled_file : test_file,
+                                     segment));
+        else
+            p_in.reset(new ProbInput(use_compiled ? compiled_file : test_file));
+        if (arg_compile.IsSet()) {
+            p_in->Compile(compiled_file);
+            MappedFile::RemoveShared(segment);  // now stale
+            return 0;
+        }
+    } catch (const std::exception &e) {
+        std::cout << "Bad input case file: " << e.what() << std::endl;
+        return 1;
+    }
+    ProbInput &in = *p_in;
+    if (!arg_index.IsSet() || !arg_cycle.IsSet() || !arg_weight.IsSet()) {
+        std::cout << "Missing -i, -c or -w" << std::endl;
+        return 1;
     }
-    ProbInput in(f);
 
     // helpers
     int weight = arg_weight.GetValue();
     VRPStateManager vrp_sm(in, weight);
+    if (arg_init.IsSet()) {
+        if (arg_init.GetValue() == "regret") {
+            vrp_sm.set_init_mode(VRPStateManager::REGRET_INIT);
+        } else if (arg_init.GetValue() == "savings") {
+            vrp_sm.set_init_mode(VRPStateManager::SAVINGS_INIT);
+        } else if (arg_init.GetValue() != "random") {
+            std::cout << "Unknown -init " << arg_init.GetValue() << std::endl;
+            return 1;
+        }
+    }
     InsMoveNeighborhoodExplorer ins_ne(in, vrp_sm, weight);
     InterSwapNeighborhoodExplorer intersw_ne(in, vrp_sm, weight);
     IntraSwapNeighborhoodExplorer intrasw_ne(in, vrp_sm, weight);
     InsMoveTabuListManager ins_tlm(4);
     InterSwapTabuListManager intersw_tlm;
     IntraSwapTabuListManager intrasw_tlm;
+    CompositeNeighborhoodExplorer cmp_ne(in, vrp_sm, ins_ne, intersw_ne,
+                                         intrasw_ne, weight);
+    CompositeTabuListManager cmp_tlm(4);
+    OrOptNeighborhoodExplorer oropt_ne(in, vrp_sm, weight);
+    OrOptTabuListManager oropt_tlm;
+    TwoOptNeighborhoodExplorer twoopt_ne(in, vrp_sm, weight);
+    TwoOptTabuListManager twoopt_tlm;
+    CrossExchangeNeighborhoodExplorer cross_ne(in, vrp_sm, weight);
+    CrossExchangeTabuListManager cross_tlm;
+    RouteSwapNeighborhoodExplorer rswap_ne(in, vrp_sm, weight);
+    RouteSwapTabuListManager rswap_tlm;
+    EjectionChainNeighborhoodExplorer chain_ne(in, vrp_sm, weight);
+    EjectionChainTabuListManager chain_tlm;
     VRPOutputManager vrp_om(in, "VRPOutputManager");
 
     // testers
@@ -87,9 +193,50 @@ int main(int argc, char *argv[]) {
                              intrasw_ne, intrasw_tlm,
                              "IntraSwapTabuSearch",
                              cl, tester, false);
+    CompositeTabuSearch ts_cmp(in, vrp_sm,
+                             cmp_ne, cmp_tlm,
+                             "CompositeTabuSearch",
+                             cl, tester, false);
+    OrOptTabuSearch ts_oropt(in, vrp_sm,
+                             oropt_ne, oropt_tlm,
+                             "OrOptTabuSearch",
+                             cl, tester, false);
+    TwoOptTabuSearch ts_twoopt(in, vrp_sm,
+                             twoopt_ne, twoopt_tlm,
+                             "TwoOptTabuSearch",
+                             cl, tester, false);
+    CrossExchangeTabuSearch ts_cross(in, vrp_sm,
+                             cross_ne, cross_tlm,
+                             "CrossExchangeTabuSearch",
+                             cl, tester, false);
+    RouteSwapTabuSearch ts_rswap(in, vrp_sm,
+                             rswap_ne, rswap_tlm,
+                             "RouteSwapTabuSearch",
+                             cl, tester, false);
+    EjectionChainTabuSearch ts_chain(in, vrp_sm,
+                             chain_ne, chain_tlm,
+                             "EjectionChainTabuSearch",
+                             cl, tester, false);
+    LargeNeighborhoodSearch lns(in, vrp_sm, "LargeNeighborhoodSearch", cl);
+    // the best plans of the cycles so far, apart by 5% of the groups
+    ElitePool elite(10, in.get_num_ogroup() / 20);
+    PathRelinking relink(in, vrp_sm, ins_ne, elite, "PathRelinking");
+    // the feasible routes the tabu runners go through
+    RoutePool route_pool(in, vrp_sm.get_evaluator(), 20000);
+    VRPSimulatedAnnealing sa(in, vrp_sm, ins_ne, intersw_ne, intrasw_ne,
+                             "SimulatedAnnealing", cl);
+    VRPLateAcceptance la(in, vrp_sm, ins_ne, intersw_ne, intrasw_ne,
+                         "LateAcceptance", cl);
 
     // solvers
     TokenRingSearch token_ring_solver(in, vrp_sm, vrp_om, "TokenRing", "./", cl);
+    // educates offspring with tabu runners of its own, one set per worker
+    HybridGeneticSearch genetic_solver(in, vrp_sm, vrp_om, "HybridGenetic",
+                                       weight, cl, tester);
+    // one thread per day, with day changes in between
+    DayDecompositionSearch decomposition_solver(in, vrp_sm, vrp_om,
+                                                "DayDecomposition", weight,
+                                                cl);
     // std::ofstream token_ring_f(log_head + "token_ring.log");
     // TokenRingObserver tr_observer(token_ring_f);
 
@@ -99,24 +246,81 @@ int main(int argc, char *argv[]) {
     ts_ins.SetMaxIteration(max_iteration);
     ts_intersw.SetMaxIteration(max_iteration);
     ts_intrasw.SetMaxIteration(max_iteration);
+    ts_cmp.SetMaxIteration(max_iteration);
+    ts_oropt.SetMaxIteration(max_iteration);
+    ts_twoopt.SetMaxIteration(max_iteration);
+    ts_cross.SetMaxIteration(max_iteration);
+    ts_rswap.SetMaxIteration(max_iteration);
+    ts_chain.SetMaxIteration(max_iteration);
+    lns.SetMaxIteration(max_iteration);
+    relink.SetMaxIteration(max_iteration);
+    // sampled moves are cheap, give them as many as a tabu scan
+    sa.SetMaxIteration(max_iteration * 100);
+    la.SetMaxIteration(max_iteration * 100);
     // token_ring_solver.AttachObserver(tr_observer);
     // ts_ins.AttachObserver(ins_ro);
     // ts_intersw.AttachObserver(inter_ro);
     // ts_intrasw.AttachObserver(intra_ro);
     token_ring_solver.SetInitTrials(2);
-    token_ring_solver.AddRunner(ts_ins);
-    token_ring_solver.AddRunner(ts_intersw);
-    token_ring_solver.AddRunner(ts_intrasw);
+    // one runner over the union of the three neighborhoods, or one each
+    if (arg_composite.IsSet()) {
+        token_ring_solver.AddRunner(ts_cmp);
+    } else {
+        token_ring_solver.AddRunner(ts_ins);
+        token_ring_solver.AddRunner(ts_intersw);
+        token_ring_solver.AddRunner(ts_intrasw);
+    }
+    if (arg_or_opt.IsSet())
+        token_ring_solver.AddRunner(ts_oropt);
+    if (arg_two_opt.IsSet())
+        token_ring_solver.AddRunner(ts_twoopt);
+    if (arg_cross.IsSet())
+        token_ring_solver.AddRunner(ts_cross);
+    if (arg_route_swap.IsSet())
+        token_ring_solver.AddRunner(ts_rswap);
+    if (arg_ejection.IsSet())
+        token_ring_solver.AddRunner(ts_chain);
+    if (arg_lns.IsSet())
+        token_ring_solver.AddRunner(lns);
+    if (arg_relink.IsSet()) {
+        token_ring_solver.AttachElitePool(elite);
+        token_ring_solver.AddRunner(relink);
+    }
+    if (arg_route_pool.IsSet()) {
+        ts_ins.AttachRoutePool(route_pool);
+        ts_intersw.AttachRoutePool(route_pool);
+        ts_intrasw.AttachRoutePool(route_pool);
+        ts_cmp.AttachRoutePool(route_pool);
+        ts_oropt.AttachRoutePool(route_pool);
+        ts_twoopt.AttachRoutePool(route_pool);
+        ts_cross.AttachRoutePool(route_pool);
+        ts_rswap.AttachRoutePool(route_pool);
+        ts_chain.AttachRoutePool(route_pool);
+        token_ring_solver.AttachRoutePool(route_pool);
+    }
+    if (arg_sa.IsSet())
+        token_ring_solver.AddRunner(sa);
+    if (arg_la.IsSet())
+        token_ring_solver.AddRunner(la);
     int cycle = arg_cycle.GetValue();
     int index = arg_index.GetValue();
-    Random::Seed((unsigned long)(time(NULL) % RANDOM_MAX + index));
+    unsigned long seed = time(NULL) % RANDOM_MAX + index;
+    Random::Seed(seed);   // what is left of EasyLocal's own draws
+    VRPRandom::Seed(seed);
+    // the other drivers replace the token ring altogether
+    AbstractLocalSearch<ProbInput, ProbOutput, RoutePlan> *solver =
+        &token_ring_solver;
+    if (arg_genetic.IsSet())
+        solver = &genetic_solver;
+    else if (arg_decomposition.IsSet())
+        solver = &decomposition_solver;
     for (int i = 0; i < cycle; ++i) {
-        token_ring_solver.Solve();
+        solver->Solve();
         std::ostringstream os_file;
         os_file << "./300/" << arg_input_file.GetValue()
                 << arg_index.GetValue() << ".out." << i;
         std::ofstream out_f(os_file.str().c_str());
-        out_f << token_ring_solver.GetOutput() << std::endl;
+        out_f << solver->GetOutput() << std::endl;
     }
 
     // int best_cost = vrp_sm.CostFunction(token_ring_solver.GetOutput());
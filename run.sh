@@ -12,6 +12,7 @@ args="-tr_TokenRing -mr $max_rounds -mir $max_idle_rounds -mit 20 \
        -ts_IntraSwapTabuSearch -mii $max_idle_iteration_for_others \
 	   -tt 13 17 "
 log="./100/"$1
+./vrptw -f $1 -cp
 for i in $(seq 40); do
     ./vrptw -f $1 $args
     printf $i >> $log
@@ -0,0 +1,254 @@
+#include "solvers/vrp_decomposition_search.h"
+#include <utils/Types.hh>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+DayOptimizer::DayOptimizer(const ProbInput &i, int weight, int day):
+    in(i), sm(i, weight), ins_ne(i, sm, weight), inter_ne(i, sm, weight),
+    intra_ne(i, sm, weight),
+    first_route_(day * i.get_num_vehicle()),
+    last_route_((day + 1) * i.get_num_vehicle()) { }
+
+int DayOptimizer::Optimize(RoutePlan &rp, unsigned max_moves) {
+    enum { NONE, INS, INTER, INTRA };
+    int total = 0;
+    InsMove ins, best_ins;
+    InterSwap inter, best_inter;
+    IntraSwap intra, best_intra;
+    for (unsigned m = 0; m < max_moves; ++m) {
+        int best = 0, kind = NONE;
+        for (unsigned a = first_route_; a < last_route_; ++a) {
+            const Route &ra = rp[a];
+            intra.route = a;
+            for (unsigned p1 = 0; p1 < ra.size(); ++p1) {
+                intra.pos1 = p1;
+                intra.ord1 = ra[p1];
+                for (unsigned p2 = p1 + 1; p2 < ra.size(); ++p2) {
+                    intra.pos2 = p2;
+                    intra.ord2 = ra[p2];
+                    if (!intra_ne.FeasibleMove(rp, intra))
+                        continue;
+                    int d = intra_ne.DeltaCostFunction(rp, intra);
+                    if (d < best) {
+                        best = d;
+                        kind = INTRA;
+                        best_intra = intra;
+                    }
+                }
+            }
+            for (unsigned b = first_route_; b < last_route_; ++b) {
+                if (b == a)
+                    continue;
+                const Route &rb = rp[b];
+                ins.old_route = a;
+                ins.new_route = b;
+                for (unsigned p = 0; p < ra.size(); ++p) {
+                    ins.old_pos = p;
+                    ins.order = ra[p];
+                    for (unsigned q = 0; q <= rb.size(); ++q) {
+                        ins.new_pos = q;
+                        if (!ins_ne.FeasibleMove(rp, ins))
+                            continue;
+                        int d = ins_ne.DeltaCostFunction(rp, ins);
+                        if (d < best) {
+                            best = d;
+                            kind = INS;
+                            best_ins = ins;
+                        }
+                    }
+                }
+                if (b < a)
+                    continue;
+                inter.route1 = a;
+                inter.route2 = b;
+                for (unsigned p1 = 0; p1 < ra.size(); ++p1) {
+                    inter.pos1 = p1;
+                    inter.ord1 = ra[p1];
+                    for (unsigned p2 = 0; p2 < rb.size(); ++p2) {
+                        inter.pos2 = p2;
+                        inter.ord2 = rb[p2];
+                        if (!inter_ne.FeasibleMove(rp, inter))
+                            continue;
+                        int d = inter_ne.DeltaCostFunction(rp, inter);
+                        if (d < best) {
+                            best = d;
+                            kind = INTER;
+                            best_inter = inter;
+                        }
+                    }
+                }
+            }
+        }
+        if (kind == NONE)
+            break;
+        if (kind == INS)
+            ins_ne.MakeMove(rp, best_ins);
+        else if (kind == INTER)
+            inter_ne.MakeMove(rp, best_inter);
+        else
+            intra_ne.MakeMove(rp, best_intra);
+        total += best;
+    }
+    return total;
+}
+
+DayDecompositionSearch::DayDecompositionSearch(
+        const ProbInput &in, VRPStateManager &e_sm, VRPOutputManager &e_om,
+        std::string name, int weight, CLParser &cl):
+    AbstractLocalSearch<ProbInput, ProbOutput, RoutePlan>(in, e_sm,
+                                                          e_om, name),
+    vrp_sm(e_sm), cross_ne(in, e_sm, weight), round_(0), idle_rounds_(0),
+    max_rounds_(20), max_idle_rounds_(2), day_moves_(1000),
+    coordination_moves_(50),
+    decomposition_arguments("dd_" + name, "dd_" + name, false),
+    arg_max_rounds("max_rounds", "mr", false),
+    arg_max_idle_rounds("max_idle_rounds", "mir", false),
+    arg_day_moves("day_moves", "dm", false),
+    arg_coordination_moves("coordination_moves", "cm", false) {
+    decomposition_arguments.AddArgument(arg_max_rounds);
+    decomposition_arguments.AddArgument(arg_max_idle_rounds);
+    decomposition_arguments.AddArgument(arg_day_moves);
+    decomposition_arguments.AddArgument(arg_coordination_moves);
+    cl.AddArgument(decomposition_arguments);
+    cl.MatchArgument(decomposition_arguments);
+    if (decomposition_arguments.IsSet()) {
+        if (arg_max_rounds.IsSet())
+            max_rounds_ = arg_max_rounds.GetValue();
+        if (arg_max_idle_rounds.IsSet())
+            max_idle_rounds_ = arg_max_idle_rounds.GetValue();
+        if (arg_day_moves.IsSet())
+            day_moves_ = arg_day_moves.GetValue();
+        if (arg_coordination_moves.IsSet())
+            coordination_moves_ = arg_coordination_moves.GetValue();
+    }
+    for (int d = 0; d < in.get_dayspan(); ++d)
+        days_.push_back(std::unique_ptr<DayOptimizer>(
+            new DayOptimizer(in, weight, d)));
+}
+
+void DayDecompositionSearch::Solve() {
+    Run();
+}
+
+void DayDecompositionSearch::ReadParameters(std::istream &is,
+                                            std::ostream &os) {
+    os << "DAY DECOMPOSITION SEARCH -- INPUT PARAMETERS" << std::endl;
+    os << "  Max number of rounds: ";
+    is >> max_rounds_;
+    os << "  Max number of idle rounds: ";
+    is >> max_idle_rounds_;
+    os << "  Max moves per day and round: ";
+    is >> day_moves_;
+    os << "  Max coordination moves per round: ";
+    is >> coordination_moves_;
+}
+
+void DayDecompositionSearch::Print(std::ostream &os) const {
+    os << "Day Decomposition Search: " << this->name << std::endl;
+    os << "  Days: " << days_.size() << std::endl;
+    os << "  Max rounds: " << max_rounds_ << std::endl;
+    os << "  Max idle rounds: " << max_idle_rounds_ << std::endl;
+    os << "  Day moves: " << day_moves_ << std::endl;
+    os << "  Coordination moves: " << coordination_moves_ << std::endl;
+}
+
+void DayDecompositionSearch::Run() {
+    if (max_idle_rounds_ == 0)
+        throw std::logic_error("Max idle round should be greater than 0");
+    this->FindInitialState();
+    this->best_state = this->current_state;
+    this->best_state_cost = this->current_state_cost;
+    round_ = 0;
+    idle_rounds_ = 0;
+    do {
+        ++round_;
+        ++idle_rounds_;
+        OptimizeDays();
+        unsigned moved = Coordinate();
+        this->current_state_cost = vrp_sm.CostFunction(this->current_state);
+        if (LessThan(this->current_state_cost, this->best_state_cost)) {
+            this->best_state = this->current_state;
+            this->best_state_cost = this->current_state_cost;
+            idle_rounds_ = 0;
+        }
+        std::cout << this->name << " round " << round_ << ", " << moved
+                  << " groups moved, cost " << this->current_state_cost
+                  << std::endl;
+    } while (round_ < max_rounds_ && idle_rounds_ < max_idle_rounds_ &&
+             !this->sm.LowerBoundReached(this->best_state_cost));
+}
+
+void DayDecompositionSearch::OptimizeDays() {
+    // each thread has its own copy to write, of which only its day's
+    // routes are taken back
+    day_plans_.assign(days_.size(), this->current_state);
+    std::vector<std::thread> workers;
+    for (unsigned d = 0; d < days_.size(); ++d)
+        workers.push_back(std::thread(&DayDecompositionSearch::OptimizeDay,
+                                      this, d));
+    for (unsigned t = 0; t < workers.size(); ++t)
+        workers[t].join();
+    int num_veh = this->in.get_num_vehicle();
+    for (unsigned d = 0; d < days_.size(); ++d) {
+        for (int r = d * num_veh; r < (int)(d + 1) * num_veh; ++r) {
+            this->current_state[r] = day_plans_[d][r];
+            this->current_state.timetable(r) = day_plans_[d].timetable(r);
+        }
+    }
+}
+
+void DayDecompositionSearch::OptimizeDay(unsigned day) {
+    days_[day]->Optimize(day_plans_[day], day_moves_);
+}
+
+bool DayDecompositionSearch::MayChangeDay(const RoutePlan &rp,
+                                          unsigned route, int og) const {
+    const OrderGroup &o = this->in.OrderGroupVect(og);
+    if (route == rp.size() - 1 || !o.IsMandatory())
+        return true;
+    std::pair<int, int> dw = o.get_dw();
+    return dw.second > dw.first ||
+        !o.IsDayFeasible(route / this->in.get_num_vehicle());
+}
+
+unsigned DayDecompositionSearch::Coordinate() {
+    RoutePlan &rp = this->current_state;
+    unsigned num_veh = this->in.get_num_vehicle();
+    unsigned moves = 0;
+    InsMove mv, best_mv;
+    for (; moves < coordination_moves_; ++moves) {
+        int best = 0;
+        for (unsigned r = 0; r < rp.size(); ++r) {
+            mv.old_route = r;
+            for (unsigned p = 0; p < rp[r].size(); ++p) {
+                mv.old_pos = p;
+                mv.order = rp[r][p];
+                if (!MayChangeDay(rp, r, mv.order))
+                    continue;
+                for (unsigned nr = 0; nr < rp.size(); ++nr) {
+                    // the unscheduled list is a day of its own
+                    if (nr / num_veh == r / num_veh)
+                        continue;
+                    mv.new_route = nr;
+                    // where it goes in the unscheduled list is no matter
+                    unsigned last = rp[nr].IsExcList() ? 0 : rp[nr].size();
+                    for (unsigned q = 0; q <= last; ++q) {
+                        mv.new_pos = q;
+                        if (!cross_ne.FeasibleMove(rp, mv))
+                            continue;
+                        int d = cross_ne.DeltaCostFunction(rp, mv);
+                        if (d < best) {
+                            best = d;
+                            best_mv = mv;
+                        }
+                    }
+                }
+            }
+        }
+        if (!best)
+            break;
+        cross_ne.MakeMove(rp, best_mv);
+    }
+    return moves;
+}
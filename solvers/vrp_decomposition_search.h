@@ -0,0 +1,79 @@
+#ifndef _VRP_DECOMPOSITION_SEARCH_H_
+#define _VRP_DECOMPOSITION_SEARCH_H_
+#include <solvers/AbstractLocalSearch.hh>
+#include <utils/CLParser.hh>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "data/route.h"
+#include "data/prob_input.h"
+#include "data/neighbor.h"
+#include "helpers/vrp_state_manager.h"
+#include "helpers/vrp_output_manager.h"
+#include "helpers/vrp_neighborhood_explorer.h"
+
+// Descent on the routes of one day with the day's groups kept on it:
+// the best improving insertion or swap between two of its routes, or
+// swap inside one, until none is left. It has a state manager and
+// explorers of its own, so that the days can be run side by side.
+class DayOptimizer {
+ public:
+    DayOptimizer(const ProbInput &in, int weight, int day);
+    // improves the routes of the day in rp, with at most max_moves
+    // moves, and returns the change of cost
+    int Optimize(RoutePlan &rp, unsigned max_moves);
+ private:
+    const ProbInput &in;
+    VRPStateManager sm;
+    InsMoveNeighborhoodExplorer ins_ne;
+    InterSwapNeighborhoodExplorer inter_ne;
+    IntraSwapNeighborhoodExplorer intra_ne;
+    unsigned first_route_, last_route_;    // the day's, last excluded
+};
+
+// Time decomposition: with the day of every order group fixed, the days
+// only share the input, and each is optimized by a DayOptimizer on a
+// thread of its own. A coordination phase then moves the groups that
+// may change day, those with a date window of more than a day, out of
+// their window or unscheduled, by the best insertion into a route of
+// another day or the unscheduled list. The two alternate until a round
+// brings no improvement for max_idle_rounds rounds.
+class DayDecompositionSearch:
+public AbstractLocalSearch<ProbInput, ProbOutput, RoutePlan> {
+ public:
+    DayDecompositionSearch(const ProbInput &in,
+                           VRPStateManager &e_sm,
+                           VRPOutputManager &e_om,
+                           std::string name,
+                           int weight,
+                           CLParser &cl);
+    void Solve();
+    void Print(std::ostream &os = std::cout) const;
+    void ReadParameters(std::istream &is = std::cin,
+                        std::ostream &os = std::cout);
+    int round() const { return round_; }
+
+ private:
+    void Run();
+    // every day on its own copy of the current state, then merged
+    void OptimizeDays();
+    void OptimizeDay(unsigned day);
+    // returns the number of moves made
+    unsigned Coordinate();
+    bool MayChangeDay(const RoutePlan &rp, unsigned route, int og) const;
+    VRPStateManager &vrp_sm;
+    InsMoveNeighborhoodExplorer cross_ne;
+    std::vector<std::unique_ptr<DayOptimizer> > days_;
+    std::vector<RoutePlan> day_plans_;
+    int round_, idle_rounds_;
+    int max_rounds_, max_idle_rounds_;
+    unsigned day_moves_, coordination_moves_;
+    ArgumentGroup decomposition_arguments;
+    ValArgument<int> arg_max_rounds;
+    ValArgument<int> arg_max_idle_rounds;
+    ValArgument<int> arg_day_moves;
+    ValArgument<int> arg_coordination_moves;
+};
+
+#endif
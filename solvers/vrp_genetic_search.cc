@@ -0,0 +1,289 @@
+#include "solvers/vrp_genetic_search.h"
+#include "helpers/vrp_random.h"
+#include <algorithm>
+#include <climits>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include "helpers/elite_pool.h"
+#include "helpers/vrp_tabu_search.h"
+
+Educator::Educator(const ProbInput &in, int weight, std::string name,
+                   CLParser &cl, AbstractTester<ProbInput, RoutePlan> &t):
+    sm(in, weight), ins_ne(in, sm, weight), inter_ne(in, sm, weight),
+    intra_ne(in, sm, weight),
+    cmp_ne(in, sm, ins_ne, inter_ne, intra_ne, weight),
+    oropt_ne(in, sm, weight), cmp_tlm(4),
+    ts_cmp(new CompositeTabuSearch(in, sm, cmp_ne, cmp_tlm,
+                                   name + "Composite", cl, t, false)),
+    ts_oropt(new OrOptTabuSearch(in, sm, oropt_ne, oropt_tlm,
+                                 name + "OrOpt", cl, t, false)) { }
+
+Educator::~Educator() { }
+
+void Educator::SetMaxIteration(unsigned long n) {
+    ts_cmp->SetMaxIteration(n);
+    ts_oropt->SetMaxIteration(n);
+}
+
+int Educator::Educate(RoutePlan &rp) {
+    sm.UpdateTimeTable(rp);
+    int cost = sm.CostFunction(rp);
+    ts_cmp->SetState(rp, cost);
+    ts_cmp->Go();
+    ts_oropt->SetState(ts_cmp->GetState(), ts_cmp->GetStateCost());
+    ts_oropt->Go();
+    rp = ts_oropt->GetState();
+    return ts_oropt->GetStateCost();
+}
+
+HybridGeneticSearch::HybridGeneticSearch(
+        const ProbInput &in, VRPStateManager &e_sm, VRPOutputManager &e_om,
+        std::string name, int weight, CLParser &cl,
+        AbstractTester<ProbInput, RoutePlan> &t):
+    AbstractLocalSearch<ProbInput, ProbOutput, RoutePlan>(in, e_sm,
+                                                          e_om, name),
+    repair(in, e_sm.get_evaluator()),
+    population_size_(12), offspring_(12),
+    num_workers_(std::max(1u, std::thread::hardware_concurrency())),
+    max_generations_(50), max_idle_generations_(10),
+    education_iterations_(200), num_close_(3),
+    generation_(0), idle_generations_(0),
+    genetic_arguments("ga_" + name, "ga_" + name, false),
+    arg_population("population", "pop", false),
+    arg_offspring("offspring", "off", false),
+    arg_workers("workers", "wk", false),
+    arg_max_generations("max_generations", "mg", false),
+    arg_max_idle_generations("max_idle_generations", "mig", false),
+    arg_education_iterations("education_iterations", "ei", false) {
+    genetic_arguments.AddArgument(arg_population);
+    genetic_arguments.AddArgument(arg_offspring);
+    genetic_arguments.AddArgument(arg_workers);
+    genetic_arguments.AddArgument(arg_max_generations);
+    genetic_arguments.AddArgument(arg_max_idle_generations);
+    genetic_arguments.AddArgument(arg_education_iterations);
+    cl.AddArgument(genetic_arguments);
+    cl.MatchArgument(genetic_arguments);
+    if (genetic_arguments.IsSet()) {
+        if (arg_population.IsSet())
+            population_size_ = arg_population.GetValue();
+        if (arg_offspring.IsSet())
+            offspring_ = arg_offspring.GetValue();
+        if (arg_workers.IsSet())
+            num_workers_ = arg_workers.GetValue();
+        if (arg_max_generations.IsSet())
+            max_generations_ = arg_max_generations.GetValue();
+        if (arg_max_idle_generations.IsSet())
+            max_idle_generations_ = arg_max_idle_generations.GetValue();
+        if (arg_education_iterations.IsSet())
+            education_iterations_ = arg_education_iterations.GetValue();
+    }
+    if (!num_workers_)
+        num_workers_ = 1;
+    // no more workers than a generation has plans to educate
+    num_workers_ = std::min(num_workers_,
+                            std::max(population_size_, offspring_));
+    for (unsigned k = 0; k < num_workers_; ++k) {
+        educators_.push_back(std::unique_ptr<Educator>(new Educator(
+            in, weight, name + "Educator" + std::to_string(k), cl, t)));
+        educators_.back()->SetMaxIteration(education_iterations_);
+    }
+}
+
+void HybridGeneticSearch::Solve() {
+    Run();
+}
+
+void HybridGeneticSearch::ReadParameters(std::istream &is,
+                                         std::ostream &os) {
+    os << "HYBRID GENETIC SEARCH -- INPUT PARAMETERS" << std::endl;
+    os << "  Population size: ";
+    is >> population_size_;
+    os << "  Offspring per generation: ";
+    is >> offspring_;
+    os << "  Max number of generations: ";
+    is >> max_generations_;
+    os << "  Max number of idle generations: ";
+    is >> max_idle_generations_;
+}
+
+void HybridGeneticSearch::Print(std::ostream &os) const {
+    os << "Hybrid Genetic Search: " << this->name << std::endl;
+    os << "  Population: " << population_size_ << " + " << offspring_
+       << std::endl;
+    os << "  Workers: " << num_workers_ << std::endl;
+    os << "  Max generations: " << max_generations_ << std::endl;
+    os << "  Max idle generations: " << max_idle_generations_ << std::endl;
+    os << "  Education iterations: " << education_iterations_ << std::endl;
+}
+
+void HybridGeneticSearch::InitializeSearch() {
+    if (population_size_ < 2)
+        throw std::logic_error("Population of " + this->name +
+                               " should be at least 2");
+    if (!offspring_)
+        throw std::logic_error("No offspring in " + this->name);
+}
+
+void HybridGeneticSearch::Run() {
+    InitializeSearch();
+    population_.clear();
+    for (unsigned k = 0; k < population_size_; ++k) {
+        this->FindInitialState();
+        population_.push_back(Individual(this->current_state));
+    }
+    Educate(0);
+    this->best_state = population_[0].plan;
+    this->best_state_cost = population_[0].cost;
+    generation_ = 0;
+    idle_generations_ = 0;
+    std::vector<int> unplaced;
+    while (true) {
+        for (unsigned i = 0; i < population_.size(); ++i) {
+            if (population_[i].cost < this->best_state_cost) {
+                this->best_state = population_[i].plan;
+                this->best_state_cost = population_[i].cost;
+                idle_generations_ = 0;
+            }
+        }
+        SelectSurvivors();
+        std::cout << this->name << " generation " << generation_
+                  << " best " << this->best_state_cost << std::endl;
+        if (generation_ >= max_generations_ ||
+            idle_generations_ >= max_idle_generations_ ||
+            this->sm.LowerBoundReached(this->best_state_cost))
+            break;
+        ++generation_;
+        ++idle_generations_;
+        unsigned first = population_.size();
+        for (unsigned k = 0; k < offspring_; ++k) {
+            unsigned a = Tournament(), b = Tournament();
+            RoutePlan child(this->in);
+            unplaced.clear();
+            Crossover(population_[a].plan, population_[b].plan, child,
+                      unplaced);
+            repair.Insert(child, unplaced);
+            population_.push_back(Individual(child));
+        }
+        Educate(first);
+    }
+    this->current_state = this->best_state;
+    this->current_state_cost = this->best_state_cost;
+}
+
+void HybridGeneticSearch::Educate(unsigned first) {
+    // the individuals are not moved while the workers run, and each
+    // worker writes its own ones only
+    std::vector<std::thread> workers;
+    for (unsigned k = 0; k < num_workers_; ++k) {
+        unsigned long seed = VRPRandom::Int(0, INT_MAX);
+        workers.push_back(std::thread(&HybridGeneticSearch::EducateShare,
+                                      this, k, first + k, seed));
+    }
+    for (unsigned k = 0; k < workers.size(); ++k)
+        workers[k].join();
+}
+
+void HybridGeneticSearch::EducateShare(unsigned worker, unsigned first,
+                                       unsigned long seed) {
+    VRPRandom::SeedThread(seed);
+    for (unsigned i = first; i < population_.size(); i += num_workers_) {
+        Individual &ind = population_[i];
+        ind.cost = educators_[worker]->Educate(ind.plan);
+        ind.plan.RouteOf(ind.route_of);
+    }
+}
+
+unsigned HybridGeneticSearch::Tournament() const {
+    unsigned a = VRPRandom::Int(0, population_.size() - 1);
+    unsigned b = VRPRandom::Int(0, population_.size() - 1);
+    return population_[a].fitness <= population_[b].fitness ? a : b;
+}
+
+void HybridGeneticSearch::Crossover(const RoutePlan &a, const RoutePlan &b,
+                                    RoutePlan &child,
+                                    std::vector<int> &unplaced) const {
+    std::vector<bool> placed(this->in.get_num_ogroup(), false);
+    std::vector<bool> from_a(a.num_routes());
+    for (unsigned r = 0; r < a.num_routes(); ++r) {
+        from_a[r] = VRPRandom::Int(0, 1);
+        if (!from_a[r])
+            continue;
+        for (unsigned k = 0; k < a[r].size(); ++k) {
+            child[r].push_back(a[r][k]);
+            placed[a[r][k]] = true;
+        }
+    }
+    // b's groups keep their route and their relative order in it
+    for (unsigned r = 0; r < b.num_routes(); ++r) {
+        if (from_a[r])
+            continue;
+        for (unsigned k = 0; k < b[r].size(); ++k) {
+            if (placed[b[r][k]])
+                continue;
+            child[r].push_back(b[r][k]);
+            placed[b[r][k]] = true;
+        }
+    }
+    for (unsigned g = 0; g < placed.size(); ++g)
+        if (!placed[g])
+            unplaced.push_back(g);
+}
+
+void HybridGeneticSearch::UpdateFitness() {
+    unsigned n = population_.size();
+    unsigned close = std::min(num_close_, n - 1);
+    // mean distance to the closest members, then the ranks
+    std::vector<std::pair<double, unsigned> > by_diversity, by_cost;
+    std::vector<unsigned> d;
+    for (unsigned i = 0; i < n; ++i) {
+        d.clear();
+        for (unsigned j = 0; j < n; ++j)
+            if (j != i)
+                d.push_back(ElitePool::Distance(population_[i].route_of,
+                                                population_[j].route_of));
+        std::partial_sort(d.begin(), d.begin() + close, d.end());
+        double sum = 0.0;
+        for (unsigned k = 0; k < close; ++k)
+            sum += d[k];
+        by_diversity.push_back(std::make_pair(close ? -sum / close : 0.0, i));
+        by_cost.push_back(std::make_pair(population_[i].cost, i));
+    }
+    std::sort(by_diversity.begin(), by_diversity.end());
+    std::sort(by_cost.begin(), by_cost.end());
+    // with few elites diversity counts in full, never above cost
+    unsigned elites = std::max(1u, population_size_ / 3);
+    double weight = n > elites ? 1.0 - double(elites) / n : 0.0;
+    for (unsigned k = 0; k < n; ++k)
+        population_[by_cost[k].second].fitness = k;
+    for (unsigned k = 0; k < n; ++k)
+        population_[by_diversity[k].second].fitness += weight * k;
+}
+
+void HybridGeneticSearch::SelectSurvivors() {
+    // a clone, with every group in the same route as an earlier member,
+    // leaves the cheaper of the two
+    for (unsigned i = 1; i < population_.size(); ) {
+        unsigned j = 0;
+        while (j < i && ElitePool::Distance(population_[i].route_of,
+                                            population_[j].route_of))
+            ++j;
+        if (j == i) {
+            ++i;
+            continue;
+        }
+        if (population_[i].cost < population_[j].cost)
+            population_[j] = population_[i];
+        population_.erase(population_.begin() + i);
+    }
+    while (population_.size() > population_size_) {
+        UpdateFitness();
+        unsigned worst = 0;
+        for (unsigned i = 1; i < population_.size(); ++i)
+            if (population_[i].fitness > population_[worst].fitness)
+                worst = i;
+        population_.erase(population_.begin() + worst);
+    }
+    UpdateFitness();
+}
@@ -0,0 +1,113 @@
+#ifndef _VRP_GENETIC_SEARCH_H_
+#define _VRP_GENETIC_SEARCH_H_
+#include <solvers/AbstractLocalSearch.hh>
+#include <testers/Tester.hh>
+#include <utils/CLParser.hh>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "data/route.h"
+#include "data/prob_input.h"
+#include "helpers/vrp_state_manager.h"
+#include "helpers/vrp_output_manager.h"
+#include "helpers/vrp_neighborhood_explorer.h"
+#include "helpers/vrp_tabu_list_manager.h"
+#include "helpers/regret_insertion.h"
+
+template <class Move> class VRPTabuSearch;
+typedef VRPTabuSearch<CompositeMove> CompositeTabuSearch;
+typedef VRPTabuSearch<OrOptMove> OrOptTabuSearch;
+
+// What one worker thread educates offspring with: a composite tabu
+// search, then an or-opt one, each for a short budget. The state
+// manager and explorers keep caches of their own, so every worker has
+// its own set and only the input is shared.
+class Educator {
+ public:
+    Educator(const ProbInput &in, int weight, std::string name,
+             CLParser &cl, AbstractTester<ProbInput, RoutePlan> &t);
+    ~Educator();
+    void SetMaxIteration(unsigned long n);
+    // improves rp, with its timetable up to date, and returns its cost
+    int Educate(RoutePlan &rp);
+ private:
+    VRPStateManager sm;
+    InsMoveNeighborhoodExplorer ins_ne;
+    InterSwapNeighborhoodExplorer inter_ne;
+    IntraSwapNeighborhoodExplorer intra_ne;
+    CompositeNeighborhoodExplorer cmp_ne;
+    OrOptNeighborhoodExplorer oropt_ne;
+    CompositeTabuListManager cmp_tlm;
+    OrOptTabuListManager oropt_tlm;
+    std::unique_ptr<CompositeTabuSearch> ts_cmp;
+    std::unique_ptr<OrOptTabuSearch> ts_oropt;
+};
+
+// Hybrid genetic search: a population of educated plans breeds
+// offspring by order-to-route crossover, each group following its route
+// in one parent or the other; the groups left out are put back by
+// regret insertion and the child is educated. Education runs on one
+// thread per worker, each drawing from a generator of its own that the
+// solver seeds for it.
+// Survivors are picked by biased fitness, the rank by cost plus the rank
+// by distance to the closest members, so that plans much like better
+// ones go first and clones go at once.
+class HybridGeneticSearch:
+public AbstractLocalSearch<ProbInput, ProbOutput, RoutePlan> {
+ public:
+    HybridGeneticSearch(const ProbInput &in,
+                        VRPStateManager &e_sm,
+                        VRPOutputManager &e_om,
+                        std::string name,
+                        int weight,
+                        CLParser &cl,
+                        AbstractTester<ProbInput, RoutePlan> &t);
+    void Solve();
+    void Print(std::ostream &os = std::cout) const;
+    void ReadParameters(std::istream &is = std::cin,
+                        std::ostream &os = std::cout);
+    unsigned generation() const { return generation_; }
+
+ private:
+    struct Individual {
+        Individual(const RoutePlan &rp): plan(rp), cost(0), fitness(0.0) { }
+        RoutePlan plan;
+        int cost;
+        std::vector<int> route_of;
+        double fitness;     // biased, lower is better
+    };
+    void Run();
+    void InitializeSearch();
+    // educates the individuals from first on, spread over the workers
+    void Educate(unsigned first);
+    // what one worker educates: every num_workers_-th from first on,
+    // drawing from a generator seeded with seed
+    void EducateShare(unsigned worker, unsigned first, unsigned long seed);
+    unsigned Tournament() const;
+    // child gets parent a's routes on a random half of the routes and
+    // parent b's groups on the others; returns the groups placed by
+    // neither
+    void Crossover(const RoutePlan &a, const RoutePlan &b,
+                   RoutePlan &child, std::vector<int> &unplaced) const;
+    void UpdateFitness();
+    // cuts the population back to population_size
+    void SelectSurvivors();
+    RegretInsertion repair;
+    std::vector<std::unique_ptr<Educator> > educators_;
+    std::vector<Individual> population_;
+    unsigned population_size_, offspring_, num_workers_;
+    unsigned max_generations_, max_idle_generations_;
+    unsigned long education_iterations_;
+    unsigned num_close_;   // members a plan's diversity is measured to
+    unsigned generation_, idle_generations_;
+    ArgumentGroup genetic_arguments;
+    ValArgument<int> arg_population;
+    ValArgument<int> arg_offspring;
+    ValArgument<int> arg_workers;
+    ValArgument<int> arg_max_generations;
+    ValArgument<int> arg_max_idle_generations;
+    ValArgument<int> arg_education_iterations;
+};
+
+#endif
@@ -26,3 +26,10 @@ void TokenRingObserver::NotifyRunnerStop(TokenRingSearch &s) {
         << s.round_ << "/" << s.max_rounds_ << ", Idle rounds "
         << s.idle_rounds_ << "/" << s.max_idle_rounds_ << std::endl;
 }
+
+void TokenRingObserver::NotifyRunnerScore(TokenRingSearch &s) {
+    const TokenRingSearch::Arm &arm = s.arms_[s.current_runner_];
+    log << "Runner: " << s.current_runner_ << ", turns: " << arm.turns
+        << ", improvement/s: " << arm.rate << ", s/iteration: "
+        << arm.iteration_time << std::endl;
+}
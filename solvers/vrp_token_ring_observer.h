@@ -10,6 +10,7 @@ class TokenRingObserver {
   void NotifyRound(TokenRingSearch&);
   void NotifyRunnerStart(TokenRingSearch&);
   void NotifyRunnerStop(TokenRingSearch&);
+  void NotifyRunnerScore(TokenRingSearch&);
  private:
   std::ostream &log;
 };
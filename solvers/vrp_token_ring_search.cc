@@ -1,5 +1,6 @@
 #include "solvers/vrp_token_ring_search.h"
 #include <utils/Types.hh>
+#include <cmath>
 #include <iostream>
 #include <stdexcept>
 #include "solvers/vrp_token_ring_observer.h"
@@ -14,16 +15,21 @@ TokenRingSearch::TokenRingSearch(const ProbInput &in,
     current_runner_(0), round_(0), idle_rounds_(0),
     max_rounds_(1), max_idle_rounds_(1), special(s),
     max_idle_trials_(0), num_trials_(0), idle_trials_(0),
+    schedule_(ROUND_ROBIN), time_slice_(0.5), exploration_(0.5),
     token_ring_arguments("tr_" + name, "tr_" + name, false),
     arg_max_rounds("max_rounds", "mr", false),
     arg_max_idle_rounds("max_idle_rounds", "mir", false),
     arg_max_idle_trials("max_idle_trials", "mit", false),
     arg_timeout("timeout", "to", false, 0.0),
-    observer(0) {
+    arg_schedule("schedule", "sch", false),
+    arg_time_slice("time_slice", "ts", false),
+    observer(0), elite_(0), route_pool_(0) {
         token_ring_arguments.AddArgument(arg_max_rounds);
         token_ring_arguments.AddArgument(arg_max_idle_rounds);
         token_ring_arguments.AddArgument(arg_max_idle_trials);
         token_ring_arguments.AddArgument(arg_timeout);
+        token_ring_arguments.AddArgument(arg_schedule);
+        token_ring_arguments.AddArgument(arg_time_slice);
     }
 
 TokenRingSearch::TokenRingSearch(const ProbInput &in,
@@ -37,15 +43,21 @@ TokenRingSearch::TokenRingSearch(const ProbInput &in,
     current_runner_(0), round_(0), idle_rounds_(0),
     max_rounds_(1), max_idle_rounds_(1), special(s),
     max_idle_trials_(0), num_trials_(0), idle_trials_(0),
+    schedule_(ROUND_ROBIN), time_slice_(0.5), exploration_(0.5),
     token_ring_arguments("tr_" + name, "tr_" + name, false),
     arg_max_rounds("max_rounds", "mr", false),
     arg_max_idle_rounds("max_idle_rounds", "mir", false),
     arg_max_idle_trials("max_idle_trials", "mit", false),
-    arg_timeout("timeout", "to", false, 0.0), observer(0) {
+    arg_timeout("timeout", "to", false, 0.0),
+    arg_schedule("schedule", "sch", false),
+    arg_time_slice("time_slice", "ts", false), observer(0),
+    elite_(0), route_pool_(0) {
     token_ring_arguments.AddArgument(arg_max_rounds);
     token_ring_arguments.AddArgument(arg_max_idle_rounds);
     token_ring_arguments.AddArgument(arg_max_idle_trials);
     token_ring_arguments.AddArgument(arg_timeout);
+    token_ring_arguments.AddArgument(arg_schedule);
+    token_ring_arguments.AddArgument(arg_time_slice);
     cl.AddArgument(token_ring_arguments);
     cl.MatchArgument(token_ring_arguments);
     if (token_ring_arguments.IsSet()) {
@@ -57,6 +69,15 @@ TokenRingSearch::TokenRingSearch(const ProbInput &in,
             max_idle_trials_ = arg_max_idle_trials.GetValue();
         if (arg_timeout.IsSet())
             this->SetTimeout(arg_timeout.GetValue());
+        if (arg_schedule.IsSet()) {
+            if (arg_schedule.GetValue() == "bandit")
+                schedule_ = BANDIT;
+            else if (arg_schedule.GetValue() != "ring")
+                throw std::invalid_argument("Unknown schedule " +
+                                            arg_schedule.GetValue());
+        }
+        if (arg_time_slice.IsSet())
+            time_slice_ = arg_time_slice.GetValue();
     }
 }
 
@@ -68,6 +89,9 @@ void TokenRingSearch::MultiStartSolve(unsigned trials) {
     RoutePlan global_best_state(this->in);
     int global_best_state_cost = 0;
     bool timeout_expired = false;
+    bool found = false;
+    starts_.Clear();
+    finals_.Clear();
 
     for (unsigned t = 0; t < trials; ++t) {
         ++num_trials_;
@@ -77,11 +101,19 @@ void TokenRingSearch::MultiStartSolve(unsigned trials) {
         std::string fname = special + ".out." + std::to_string(t+1);
         std::ofstream fout(fname.c_str());
         fout << this->best_state << std::endl;
-        if (t == 0 || LessThan(this->best_state_cost, global_best_state_cost)) {
-            global_best_state = this->best_state;
-            global_best_state_cost = this->best_state_cost;
-            if (LowerBoundReached(global_best_state_cost)) break;
-            if (t) idle_trials_ = 0;
+        // a trial ending where an earlier one did has nothing to add
+        if (!finals_.Visit(this->best_state)) {
+            std::cout << this->name << " trial " << t + 1
+                      << " repeats an earlier one." << std::endl;
+        } else {
+            if (!found ||
+                LessThan(this->best_state_cost, global_best_state_cost)) {
+                global_best_state = this->best_state;
+                global_best_state_cost = this->best_state_cost;
+                if (LowerBoundReached(global_best_state_cost)) break;
+                if (found) idle_trials_ = 0;
+                found = true;
+            }
         }
 #ifdef _VRP_HAVE_PTHREAD_
         if (this->timeout_set) {
@@ -97,6 +129,9 @@ void TokenRingSearch::MultiStartSolve(unsigned trials) {
         // }
         if (timeout_expired) break;
     }
+    // routes of all the trials together
+    if (found && route_pool_ != NULL)
+        Recombine(global_best_state, global_best_state_cost);
     this->best_state = global_best_state;
     this->best_state_cost = global_best_state_cost;
 }
@@ -108,12 +143,19 @@ void TokenRingSearch::InitializeSearch() {
         throw std::logic_error("Max idle round should be greater than 0");
     if (!p_runners.size())
         throw std::logic_error("No runner in " + this->name);
+    Arm fresh = { 0, 0.0, 0.0 };
+    arms_.assign(p_runners.size(), fresh);
     // this->SetTimeout(500.0);
 }
 
 void TokenRingSearch::Run() {
     InitializeSearch();
     this->FindInitialState();
+    // a start seen before would only repeat an earlier trial; the last
+    // redraw is visited too, whether or not it is new
+    for (int k = 0; !starts_.Visit(this->current_state) && k < kMaxRedraws;
+         ++k)
+        this->FindInitialState();
     bool timeout_expired = false;
     bool lower_bound_reached = false;
     chrono.Reset();
@@ -128,34 +170,133 @@ void TokenRingSearch::Run() {
     do {
         ++round_;
         ++idle_rounds_;
-        for (RunnerType *p_r : p_runners) {
-            // fout << "-- " << "round: " << round_ << ", "
-            //           << current_runner_  << std::endl;
-            // fout << this->current_state << std::endl;
-            p_r->SetState(this->current_state, this->current_state_cost);
-            // if (observer != NULL) observer->NotifyRunnerStart(*this);
-            // fout << "Timeout before: " << this->current_timeout;
-            timeout_expired = this->LetGo(*p_r);
-            // fout << "  after: " <<  this->current_timeout << std::endl;
-            // fout << "--" << std::endl;
-            // if (observer != NULL) observer->NotifyRunnerStop(*this);
-            this->current_state = p_runners[current_runner_]->GetState();
-            this->current_state_cost = p_r->GetStateCost();
-            if (LessThan(this->current_state_cost, this->best_state_cost)) {
-                idle_rounds_ = 0;
-                this->best_state = this->current_state;
-                this->best_state_cost = this->current_state_cost;
-                lower_bound_reached = LowerBoundReached(this->best_state_cost);
+        if (schedule_ == BANDIT) {
+            timeout_expired = BanditRound(lower_bound_reached);
+        } else {
+            for (unsigned k = 0; k < p_runners.size(); ++k) {
+                // fout << "-- " << "round: " << round_ << ", "
+                //           << current_runner_  << std::endl;
+                // fout << this->current_state << std::endl;
+                // if (observer != NULL) observer->NotifyRunnerStart(*this);
+                timeout_expired = LetRunnerGo(current_runner_,
+                                              lower_bound_reached);
+                // if (observer != NULL) observer->NotifyRunnerStop(*this);
+                current_runner_ = (current_runner_ + 1) % p_runners.size();
+                // if (observer != NULL) observer->NotifyRound(*this);
+                if (lower_bound_reached || timeout_expired) break;
             }
-            current_runner_ = (current_runner_ + 1) % p_runners.size();
-            // if (observer != NULL) observer->NotifyRound(*this);
-            if (lower_bound_reached || timeout_expired) break;
+        }
+        if (route_pool_ != NULL && !lower_bound_reached &&
+            Recombine(this->current_state, this->current_state_cost) &&
+            LessThan(this->current_state_cost, this->best_state_cost)) {
+            idle_rounds_ = 0;
+            this->best_state = this->current_state;
+            this->best_state_cost = this->current_state_cost;
+            lower_bound_reached = LowerBoundReached(this->best_state_cost);
         }
         std::cout << this->name << " #" << num_trials_ << " trials,"
                   << " round " << round_ << " finished." << std::endl;
     }while(round_ < max_rounds_ && idle_rounds_ < max_idle_rounds_
            && !lower_bound_reached && !timeout_expired);
     chrono.Stop();
+    if (elite_ != NULL)
+        elite_->Insert(this->best_state, this->best_state_cost);
+}
+
+bool TokenRingSearch::LetRunnerGo(unsigned i, bool &lower_bound_reached) {
+    RunnerType *p_r = p_runners[i];
+    p_r->SetState(this->current_state, this->current_state_cost);
+    bool timeout_expired = this->LetGo(*p_r);
+    this->current_state = p_r->GetState();
+    this->current_state_cost = p_r->GetStateCost();
+    if (route_pool_ != NULL)
+        route_pool_->Harvest(this->current_state);
+    if (LessThan(this->current_state_cost, this->best_state_cost)) {
+        idle_rounds_ = 0;
+        this->best_state = this->current_state;
+        this->best_state_cost = this->current_state_cost;
+        lower_bound_reached = LowerBoundReached(this->best_state_cost);
+    }
+    return timeout_expired;
+}
+
+bool TokenRingSearch::BanditRound(bool &lower_bound_reached) {
+    bool timeout_expired = false;
+    for (unsigned k = 0; k < p_runners.size(); ++k) {
+        current_runner_ = SelectRunner();
+        RunnerType *p_r = p_runners[current_runner_];
+        Arm &arm = arms_[current_runner_];
+        unsigned long max_iteration = p_r->MaxIteration();
+        if (time_slice_ > 0.0 && arm.iteration_time > 0.0) {
+            double slice = time_slice_ / arm.iteration_time;
+            if (slice < max_iteration)
+                p_r->SetMaxIteration(slice < 1.0 ? 1 :
+                                     static_cast<unsigned long>(slice));
+        }
+        int start_cost = this->current_state_cost;
+        if (observer != NULL) observer->NotifyRunnerStart(*this);
+        Chronometer turn;
+        turn.Reset();
+        turn.Start();
+        timeout_expired = LetRunnerGo(current_runner_, lower_bound_reached);
+        turn.Stop();
+        if (observer != NULL) observer->NotifyRunnerStop(*this);
+        p_r->SetMaxIteration(max_iteration);
+
+        double seconds = turn.TotalTime() > 1e-6 ? turn.TotalTime() : 1e-6;
+        double rate = (start_cost - this->current_state_cost) / seconds;
+        arm.rate = arm.turns ? 0.7 * arm.rate + 0.3 * rate : rate;
+        if (p_r->GetIterationsPerformed())
+            arm.iteration_time = seconds / p_r->GetIterationsPerformed();
+        ++arm.turns;
+        if (observer != NULL) observer->NotifyRunnerScore(*this);
+        if (lower_bound_reached || timeout_expired) break;
+    }
+    return timeout_expired;
+}
+
+unsigned TokenRingSearch::SelectRunner() const {
+    int turns = 0;
+    double max_rate = 0.0;
+    for (unsigned i = 0; i < arms_.size(); ++i) {
+        if (!arms_[i].turns)
+            return i;   // everyone plays once first
+        turns += arms_[i].turns;
+        if (arms_[i].rate > max_rate)
+            max_rate = arms_[i].rate;
+    }
+    unsigned best = 0;
+    double best_score = -1.0;
+    for (unsigned i = 0; i < arms_.size(); ++i) {
+        double score = (max_rate > 0.0 ? arms_[i].rate / max_rate : 0.0) +
+            exploration_ * std::sqrt(2.0 * std::log(turns) / arms_[i].turns);
+        if (score > best_score) {
+            best = i;
+            best_score = score;
+        }
+    }
+    return best;
+}
+
+bool TokenRingSearch::Recombine(RoutePlan &rp, int &cost) {
+    RoutePlan recombined(this->in);
+    int recombined_cost = route_pool_->Recombine(rp, recombined);
+    if (!LessThan(recombined_cost, cost))
+        return false;
+    // pricing it once more sets its violations, which the runners compare
+    int priced_cost = this->sm.CostFunction(recombined);
+    if (priced_cost != recombined_cost) {
+        std::cout << this->name << " recombination priced " << priced_cost
+                  << " instead of " << recombined_cost << ", dropped"
+                  << std::endl;
+        return false;
+    }
+    std::cout << this->name << " recombined " << route_pool_->size()
+              << " pooled routes: " << cost << " -> " << recombined_cost
+              << std::endl;
+    rp = recombined;
+    cost = recombined_cost;
+    return true;
 }
 
 bool TokenRingSearch::LowerBoundReached(int state_cost) const {
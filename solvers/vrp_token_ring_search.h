@@ -11,6 +11,9 @@
 #include "data/prob_input.h"
 #include "helpers/vrp_state_manager.h"
 #include "helpers/vrp_output_manager.h"
+#include "helpers/solution_memory.h"
+#include "helpers/elite_pool.h"
+#include "helpers/route_pool.h"
 
 #define _VRP_HAVE_PTHREAD_
 
@@ -21,6 +24,11 @@ public AbstractLocalSearch<ProbInput, ProbOutput, RoutePlan> {
 
  public:
     typedef Runner<ProbInput, RoutePlan> RunnerType;
+    // ROUND_ROBIN lets every runner go once per round, in order;
+    // BANDIT picks each of the round's turns by UCB1 over the runners'
+    // recent cost improvement per second and caps a turn at time_slice
+    // seconds, converted to iterations from the runner's measured speed
+    enum Schedule { ROUND_ROBIN, BANDIT };
     TokenRingSearch(const ProbInput &in,
                     VRPStateManager &e_sm,
                     VRPOutputManager &e_om,
@@ -36,6 +44,12 @@ public AbstractLocalSearch<ProbInput, ProbOutput, RoutePlan> {
     void Solve();
     void MultiStartSolve(unsigned);
     void AttachObserver(TokenRingObserver &tro) { observer = &tro; }
+    // every run offers its best plan to the pool
+    void AttachElitePool(ElitePool &pool) { elite_ = &pool; }
+    // the routes of every turn go to the pool, and after every round,
+    // and once more at the end of MultiStartSolve, the pool's best
+    // recombination of routes replaces the plan if it costs less
+    void AttachRoutePool(RoutePool &pool) { route_pool_ = &pool; }
     void AddRunner(RunnerType&);
     void RemoveRunner(RunnerType&);
     void Print(std::ostream &os = std::cout) const;
@@ -46,11 +60,28 @@ public AbstractLocalSearch<ProbInput, ProbOutput, RoutePlan> {
     void set_max_rounds(unsigned r) { max_rounds_ = r; }
     void set_max_idle_rounds(unsigned r) { max_idle_rounds_ = r; }
 	int get_num_trials() const { return num_trials_; }
+    void set_schedule(Schedule s) { schedule_ = s; }
+    void set_time_slice(double t) { time_slice_ = t; }
 
  private:
+    // what the bandit knows about a runner
+    struct Arm {
+        int turns;
+        double rate;            // smoothed improvement per second
+        double iteration_time;  // seconds per iteration, 0 if unknown
+    };
     void Run();
     void InitializeSearch();
+    // one turn of runner i from the current state; true on timeout
+    bool LetRunnerGo(unsigned i, bool &lower_bound_reached);
+    bool BanditRound(bool &lower_bound_reached);
+    unsigned SelectRunner() const;
     bool LowerBoundReached(int state_cost) const;
+    // the pool's recombination from rp, taken if it costs less; true
+    // if it was
+    bool Recombine(RoutePlan &rp, int &cost);
+    // fresh initial states drawn before giving up on a seen one
+    static const int kMaxRedraws = 10;
     std::vector<RunnerType*> p_runners;
     unsigned current_runner_;
     int round_;
@@ -60,12 +91,22 @@ public AbstractLocalSearch<ProbInput, ProbOutput, RoutePlan> {
     int max_idle_trials_;
     int num_trials_;
     int idle_trials_;
+    Schedule schedule_;
+    double time_slice_;
+    double exploration_;
+    std::vector<Arm> arms_;
+    // initial and final states of the trials so far
+    SolutionMemory starts_, finals_;
     ArgumentGroup token_ring_arguments;
     ValArgument<int> arg_max_rounds;
     ValArgument<int> arg_max_idle_rounds;
     ValArgument<int> arg_max_idle_trials;
     ValArgument<double> arg_timeout;
+    ValArgument<std::string> arg_schedule;
+    ValArgument<double> arg_time_slice;
     TokenRingObserver *observer;
+    ElitePool *elite_;
+    RoutePool *route_pool_;
     Chronometer chrono;
 };
 